@@ -0,0 +1,26 @@
+// Timing helpers of the benchmarks, which are built with optimizations and run by "./build.sh bench"
+#ifndef HOPE_BENCH_H
+#define HOPE_BENCH_H
+
+#include <time.h>
+
+// Current time in nanoseconds
+static double bench_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Run the statements runs times and store the fastest run in nanoseconds in best, it is the least disturbed one
+#define BENCH_BEST(runs, best, ...) do { \
+    (best) = 1e300; \
+    for(int bench_run = 0; bench_run < (runs); bench_run++){ \
+        double bench_start = bench_now(); \
+        __VA_ARGS__; \
+        double bench_took = bench_now() - bench_start; \
+        if(bench_took < (best)) \
+            (best) = bench_took; \
+    } \
+} while(0)
+
+#endif
@@ -0,0 +1,102 @@
+// Every argument is classified once per parse, for the walks of all sets. Only arguments that can be a name are hashed
+// and measured, no further than the longest name. A million arguments are classified against a set of 21 names and
+// compared to the classification before, which measured every argument with strlen. Both have to give the same tokens.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+#include "bench.h"
+
+#define NARGS 1000000
+
+static char storage[NARGS][48];
+static char *args[NARGS + 1];
+static hope_token_t tokens[NARGS];
+static hope_token_t measured_tokens[NARGS];
+
+static const char *names[] = {
+    "-v", "-q", "-o", "-I", "-L", "-l", "-D", "-O", "-g", "-c", "-j",
+    "--verbose", "--quiet", "--output", "--level", "--define", "--jobs", "--jobserver", "--keep-going", "--dry-run", "--help"
+};
+
+// The classification before, every argument is measured
+static void classify_measured(const hope_table_t *table, const char *arg, hope_token_t *token){
+    token->kind = 0;
+    token->hash = 0;
+    if(arg[0] == '-')
+        token->kind |= arg[1] != '-' ? HOPE_TOKEN_SHORT : (arg[2] == '\0' ? HOPE_TOKEN_SEPARATOR : HOPE_TOKEN_LONG);
+    if(hope_looks_numeric(arg))
+        token->kind |= HOPE_TOKEN_NUMERIC;
+    bool candidate = !(token->kind & HOPE_TOKEN_SEPARATOR) && hope_first_char_in(table->first_chars, arg[0]) &&
+                     (table->numeric_names || !(token->kind & HOPE_TOKEN_NUMERIC));
+    if(candidate){
+        token->hash = hope_hash(arg, table->max_len, &token->len);
+        if(arg[token->len] == '\0'){
+            token->kind |= HOPE_TOKEN_CANDIDATE;
+            return;
+        }
+        token->hash = 0;
+        token->len += strlen(arg + token->len);
+        return;
+    }
+    token->len = strlen(arg);
+}
+
+// Classify all arguments both ways, check that the tokens are the same and print the timings
+static int run(const hope_table_t *table, const char *workload){
+    double best, classify_ms;
+    // both classify into arrays of their own, so neither pays for allocating the tokens
+    BENCH_BEST(50, best, for(size_t i = 0; i < NARGS; i++) hope_classify(table, args[i], tokens + i));
+    classify_ms = best / 1e6;
+    BENCH_BEST(50, best, for(size_t i = 0; i < NARGS; i++) classify_measured(table, args[i], measured_tokens + i));
+    int mismatches = 0;
+    for(size_t i = 0; i < NARGS; i++){
+        // only the length of candidates is still kept, and numbers are not flagged where they can not be names
+        unsigned kind = measured_tokens[i].kind & ~(unsigned)HOPE_TOKEN_NUMERIC;
+        bool candidate = kind & HOPE_TOKEN_CANDIDATE;
+        if((tokens[i].kind & ~(unsigned)HOPE_TOKEN_NUMERIC) != kind || tokens[i].hash != measured_tokens[i].hash ||
+           (candidate && tokens[i].len != measured_tokens[i].len))
+            mismatches++;
+    }
+    printf("%-36s classified %6.2f ms, measuring every argument %6.2f ms\n", workload, classify_ms, best / 1e6);
+    if(mismatches)
+        fprintf(stderr, "classify: %d tokens differ from the classification measuring every argument\n", mismatches);
+    return mismatches;
+}
+
+int main(void){
+    hope_t hope = hope_init("classify", NULL);
+    hope_set_t set = hope_init_set("build");
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        hope_add_param(&set, hope_init_param(names[i], NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+    if(hope_compile(&hope) != HOPE_SUCCESS_CODE)
+        return 1;
+
+    srand(1);
+    for(int i = 0; i < NARGS; i++){
+        if(i % 16 == 0)
+            snprintf(storage[i], sizeof(storage[i]), "%s", names[rand() % 11]);
+        else
+            snprintf(storage[i], sizeof(storage[i]), "src/module%d/source_file_%d.c", rand() % 100, rand());
+        args[i] = storage[i];
+    }
+    args[NARGS] = NULL;
+    int failures = run(hope.table, "file paths, few dashes");
+
+    for(int i = 0; i < NARGS; i++){
+        switch(rand() % 4){
+            case 0: snprintf(storage[i], sizeof(storage[i]), "--level=%d", rand() % 10); break;
+            case 1: snprintf(storage[i], sizeof(storage[i]), "-DFEATURE_%d=1", rand() % 1000); break;
+            case 2: snprintf(storage[i], sizeof(storage[i]), "-Wl,--section-start=.text%d", rand() % 100); break;
+            default: snprintf(storage[i], sizeof(storage[i]), "%s", names[rand() % 21]); break;
+        }
+    }
+    failures += run(hope.table, "--level=N, -D, long -Wl,... values");
+
+    hope_free(&hope);
+    return failures != 0;
+}
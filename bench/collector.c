@@ -0,0 +1,74 @@
+// Storing the values of a collector: a find-style argument list with 200,000 paths is parsed into a string collector.
+// The paths can only be values, so the tokens count them as one run, which the counting walk adds up without reading
+// them and the fill stores into an array allocated once. "./build.sh bench" also builds this program against the
+// header from before the counting walk, where every value was appended to its result on its own, and runs both.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#ifdef HOPE_BENCH_HEADER
+#include HOPE_BENCH_HEADER
+#else
+#define HOPE_ALLOC_STATS
+#include "../hope.h"
+#endif
+#include "bench.h"
+
+#define NPATHS 200000
+
+static char paths[NPATHS][32];
+static char *args[NPATHS + 3];
+
+static hope_t init_find(void){
+    hope_t hope = hope_init("collector", NULL);
+    hope_set_t set = hope_init_set("find");
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_NONE));
+    hope_add_param(&set, hope_init_param("-name", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_set(&hope, set);
+    return hope;
+}
+
+// Parse the paths with a new parser, as a program does once, and count the calls to its allocator where it has them
+static int parse_fresh(size_t *calls){
+    hope_t hope = init_find();
+    const char **values;
+#ifdef HOPE_ALLOC_STATS
+    size_t before = hope.alloc.calls;
+#endif
+    int ok = hope_parse(&hope, args) == HOPE_SUCCESS_CODE && hope_get_string(&hope, NULL, &values) == NPATHS &&
+             !strcmp(values[NPATHS - 1], paths[NPATHS - 1]);
+#ifdef HOPE_ALLOC_STATS
+    *calls = hope.alloc.calls - before;
+#else
+    *calls = 0;
+#endif
+    hope_free(&hope);
+    return ok;
+}
+
+int main(void){
+    args[0] = "-v";
+    for(int i = 0; i < NPATHS; i++){
+        snprintf(paths[i], sizeof(paths[i]), "src/dir%d/file%d.c", i % 97, i);
+        args[i + 1] = paths[i];
+    }
+    args[NPATHS + 1] = NULL;
+
+    double best;
+    size_t calls = 0;
+    int ok = 1;
+    BENCH_BEST(20, best, ok &= parse_fresh(&calls));
+#ifdef HOPE_BENCH_HEADER
+    printf("%d paths: previous parser %.2f ms\n", NPATHS, best / 1e6);
+#else
+    double fresh_ms = best / 1e6;
+    // a parser that is reset between parses reuses its memory
+    hope_t hope = init_find();
+    BENCH_BEST(20, best, hope_reset(&hope); ok &= hope_parse(&hope, args) == HOPE_SUCCESS_CODE);
+    hope_free(&hope);
+    printf("%d paths: hope %.2f ms with %zu allocations, %.2f ms reused\n", NPATHS, fresh_ms, calls, best / 1e6);
+#endif
+    return !ok;
+}
@@ -0,0 +1,115 @@
+// The shell runs the program for every completion, which adds its parameters and answers the words. A completion does
+// not compile the sets, it bisects the names of every set in order. 10,000 flags are spread over 20 sets and
+// completed for words matching one, a few hundred and all of them, and for a value. The flags are declared as static
+// tables written in name order, which are used as they are, and added with hope_add_param in the order of their
+// numbers, which a completion has to sort first. The program fails if adding the static tables and answering a
+// completion take 1 ms or more together.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+#include "bench.h"
+
+#define NSETS 20
+#define NFLAGS 10000
+#define PER_SET (NFLAGS / NSETS)
+#define RUNS 20
+#define BUDGET_MS 1.0
+
+static char names[NFLAGS][24];
+static char set_names[NSETS][16];
+static hope_param_t tables[NSETS][PER_SET];
+
+// Every tenth flag takes a string and the rest are switches
+static hope_param_t init_flag(int i){
+    bool value = i % 10 == 0;
+    return hope_init_param(names[i], NULL, value ? HOPE_TYPE_STRING : HOPE_TYPE_SWITCH, value ? 1 : HOPE_ARGC_NONE);
+}
+
+static int compare_names(const void *a, const void *b){
+    return strcmp(((const hope_param_t*)a)->name, ((const hope_param_t*)b)->name);
+}
+
+// Add the static tables, as a program declaring its flags that way does
+static hope_t init_static(void){
+    hope_t hope = hope_init("complete", NULL);
+    for(int s = 0; s < NSETS; s++)
+        hope_add_set(&hope, hope_init_static_set(set_names[s], tables[s], PER_SET));
+    return hope;
+}
+
+// Add the flags one by one, as a program building its sets does
+static hope_t init_dynamic(void){
+    hope_t hope = hope_init("complete", NULL);
+    for(int s = 0; s < NSETS; s++){
+        hope_set_t set = hope_init_set(set_names[s]);
+        for(int i = s; i < NFLAGS; i += NSETS)
+            hope_add_param(&set, init_flag(i));
+        hope_add_set(&hope, set);
+    }
+    return hope;
+}
+
+int main(void){
+    for(int s = 0; s < NSETS; s++)
+        snprintf(set_names[s], sizeof(set_names[s]), "set%d", s);
+    for(int i = 0; i < NFLAGS; i++)
+        snprintf(names[i], sizeof(names[i]), "--flag-%d", i);
+    // the tables are written in name order, here they are sorted before anything is timed
+    for(int s = 0; s < NSETS; s++){
+        for(int i = s; i < NFLAGS; i += NSETS)
+            tables[s][i / NSETS] = init_flag(i);
+        qsort(tables[s], PER_SET, sizeof(hope_param_t), compare_names);
+    }
+    FILE *sink = fopen("/dev/null", "w");
+    if(!sink)
+        return 1;
+
+    static const struct {
+        const char *name;
+        char *words[3];
+    } cases[] = {
+        {"one name", {"--flag-1234", NULL}},
+        {"names starting with --flag-12", {"--flag-12", NULL}},
+        {"all 10,000 names", {"", NULL}},
+        {"names starting with -", {"-", NULL}},
+        {"the value of --flag-10", {"--flag-10", "", NULL}},
+    };
+    static const struct {
+        const char *name;
+        hope_t (*init)(void);
+        bool budget;
+    } ways[] = {
+        {"static tables in name order", init_static, true},
+        {"hope_add_param", init_dynamic, false},
+    };
+    int failures = 0;
+    for(size_t w = 0; w < sizeof(ways) / sizeof(ways[0]); w++){
+        printf("%-32s %10s %10s %10s\n", ways[w].name, "setup us", "answer us", "total us");
+        for(size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++){
+            char *argv[5] = {"complete", HOPE_COMPLETE_ARG, cases[c].words[0], cases[c].words[1], NULL};
+            // every run is the first completion of a new parser, as in a new process
+            double setup = 1e300, answer = 1e300, total = 1e300;
+            for(int run = 0; run < RUNS; run++){
+                double start = bench_now();
+                hope_t hope = ways[w].init();
+                double added = bench_now();
+                failures += !hope_complete_argv(&hope, argv, sink);
+                double answered = bench_now();
+                hope_free(&hope);
+                setup = added - start < setup ? added - start : setup;
+                answer = answered - added < answer ? answered - added : answer;
+                total = answered - start < total ? answered - start : total;
+            }
+            printf("  %-30s %10.1f %10.1f %10.1f\n", cases[c].name, setup / 1e3, answer / 1e3, total / 1e3);
+            if(ways[w].budget && total / 1e6 >= BUDGET_MS){
+                fprintf(stderr, "complete: completing %s takes more than %.0f ms\n", cases[c].name, BUDGET_MS);
+                failures++;
+            }
+        }
+    }
+    fclose(sink);
+    return failures != 0;
+}
@@ -0,0 +1,75 @@
+// Doubles are converted by hope_parse_double, which takes Clinger's fast path for most command-line values and hands
+// the rest to strtod. A million values in three formats are converted and compared to strtod with the end pointer
+// checked, the way they used to be converted. tests/double_roundtrip.c checks that both give the same bits.
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+#include "bench.h"
+
+#define NVALUES 1000000
+
+static char numbers[NVALUES][32];
+static char *args[NVALUES + 1];
+static double values[NVALUES];
+
+// Convert an argument the way the collector did before, the whole argument has to be the number
+static int strtod_whole(const char *str, double *value){
+    char *end;
+    *value = strtod(str, &end);
+    return end != str && *end == '\0';
+}
+
+int main(void){
+    static const struct {
+        const char *name;
+        const char *format;
+        double scale;
+    } formats[] = {
+        {"%.6f coordinates", "%.6f", 360.0},
+        {"%.4g weights", "%.4g", 1.0},
+        {"%.17g full precision (strtod)", "%.17g", 1e6},
+    };
+    int failures = 0;
+    srand(1);
+    printf("%-32s %12s %12s\n", "values", "hope ns", "strtod ns");
+    for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++){
+        for(int i = 0; i < NVALUES; i++){
+            double value = ((double)rand() / RAND_MAX - 0.5) * formats[f].scale;
+            snprintf(numbers[i], sizeof(numbers[i]), formats[f].format, value);
+            args[i] = numbers[i];
+        }
+        args[NVALUES] = NULL;
+        double best, hope_ns;
+        BENCH_BEST(7, best, for(int i = 0; i < NVALUES; i++) failures += hope_parse_double(args[i], values + i) != HOPE_SUCCESS_CODE);
+        hope_ns = best / NVALUES;
+        BENCH_BEST(7, best, for(int i = 0; i < NVALUES; i++) failures += !strtod_whole(args[i], values + i));
+        printf("%-32s %12.1f %12.1f\n", formats[f].name, hope_ns, best / NVALUES);
+    }
+
+    // the formats mixed, as the arguments of a collector
+    for(int i = 0; i < NVALUES; i++){
+        double value = ((double)rand() / RAND_MAX - 0.5) * 1000.0;
+        snprintf(numbers[i], sizeof(numbers[i]), formats[i % 3].format, value);
+    }
+    hope_t hope = hope_init("doubles", NULL);
+    hope_set_t set = hope_init_set("numbers");
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_MORE));
+    hope_add_set(&hope, set);
+    double best, hope_ms;
+    BENCH_BEST(7, best, hope_reset(&hope); failures += hope_parse(&hope, args) != HOPE_SUCCESS_CODE);
+    hope_ms = best / 1e6;
+    // the old way: keep the strings while parsing and convert every one with strtod
+    hope.flags |= HOPE_FLAG_LAZY;
+    BENCH_BEST(7, best,
+        hope_reset(&hope);
+        failures += hope_parse(&hope, args) != HOPE_SUCCESS_CODE;
+        for(int i = 0; i < NVALUES; i++) strtod_whole(args[i], values + i));
+    hope_free(&hope);
+    printf("%d mixed doubles: collector parse %.1f ms, with strtod %.1f ms\n", NVALUES, hope_ms, best / 1e6);
+
+    if(failures)
+        fprintf(stderr, "doubles: %d values failed to convert\n", failures);
+    return failures != 0;
+}
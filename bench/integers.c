@@ -0,0 +1,91 @@
+// Integers are converted by hope_parse_long, which checks the whole argument without strtol and the locale.
+// A million random values of 1 to 19 digits are converted alone and as the arguments of an integer collector,
+// against strtol with the end pointer checked, the way the collector used to convert them. For the collector the
+// old way is a parse that keeps the values as strings (HOPE_FLAG_LAZY) followed by strtol over every value.
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+#include "bench.h"
+
+#define NVALUES 1000000
+
+static char numbers[NVALUES][24];
+static char *args[NVALUES + 1];
+static long int values[NVALUES];
+
+// Convert an argument the way the collector did before, the whole argument has to be the number.
+// strtol skips leading spaces, which hope_parse_long rejects like the trailing ones
+static int strtol_whole(const char *str, long int *value){
+    if(isspace((unsigned char)*str))
+        return 0;
+    char *end;
+    errno = 0;
+    *value = strtol(str, &end, 10);
+    return end != str && *end == '\0' && errno != ERANGE;
+}
+
+int main(void){
+    srand(1);
+    for(int i = 0; i < NVALUES; i++){
+        int digits = 1 + rand() % 19;
+        char *cur = numbers[i];
+        if(rand() % 4 == 0)
+            *cur++ = '-';
+        // a 19 digit value starting with 9 could overflow, the collector would reject it
+        *cur++ = (char)('1' + rand() % (digits == 19 ? 8 : 9));
+        for(int d = 1; d < digits; d++)
+            *cur++ = (char)('0' + rand() % 10);
+        *cur = '\0';
+        args[i] = numbers[i];
+    }
+    args[NVALUES] = NULL;
+
+    // both conversions have to agree on every value before their timings mean anything
+    static const char *edges[] = {"9223372036854775807", "9223372036854775808", "-9223372036854775808",
+                                  "-9223372036854775809", "99999999999999999999", "+5", "007", "-0",
+                                  "", "-", "12abc", " 1", "1 "};
+    int disagreed = 0;
+    for(int i = 0; i < NVALUES + (int)(sizeof(edges) / sizeof(edges[0])); i++){
+        const char *str = i < NVALUES ? args[i] : edges[i - NVALUES];
+        long int hope_value, strtol_value;
+        int hope_ok = hope_parse_long(str, &hope_value) == HOPE_SUCCESS_CODE;
+        int strtol_ok = strtol_whole(str, &strtol_value);
+        if(hope_ok != strtol_ok || (hope_ok && hope_value != strtol_value))
+            disagreed++;
+    }
+
+    double best, hope_ns, strtol_ns;
+    BENCH_BEST(7, best, for(int i = 0; i < NVALUES; i++) hope_parse_long(args[i], values + i));
+    hope_ns = best / NVALUES;
+    BENCH_BEST(7, best, for(int i = 0; i < NVALUES; i++) strtol_whole(args[i], values + i));
+    strtol_ns = best / NVALUES;
+    printf("%d integers: hope_parse_long %.1f ns/value, strtol %.1f ns/value\n", NVALUES, hope_ns, strtol_ns);
+
+    int failures = 0;
+    hope_t hope = hope_init("integers", NULL);
+    hope_set_t set = hope_init_set("numbers");
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_MORE));
+    hope_add_set(&hope, set);
+    BENCH_BEST(7, best, hope_reset(&hope); failures += hope_parse(&hope, args) != HOPE_SUCCESS_CODE);
+    double hope_ms = best / 1e6;
+    long int *collected;
+    if(hope_get_integer(&hope, NULL, &collected) != NVALUES)
+        failures++;
+    hope.flags |= HOPE_FLAG_LAZY;
+    BENCH_BEST(7, best,
+        hope_reset(&hope);
+        failures += hope_parse(&hope, args) != HOPE_SUCCESS_CODE;
+        for(int i = 0; i < NVALUES; i++) strtol_whole(args[i], values + i));
+    hope_free(&hope);
+    printf("%d integers: collector parse %.1f ms, with strtol %.1f ms\n", NVALUES, hope_ms, best / 1e6);
+
+    if(disagreed)
+        fprintf(stderr, "integers: %d values did not agree with strtol\n", disagreed);
+    if(failures)
+        fprintf(stderr, "integers: the collector failed to parse the values\n");
+    return disagreed || failures;
+}
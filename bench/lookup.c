@@ -0,0 +1,57 @@
+// Looking up a parameter by its name costs the same however many parameters the set has.
+// Every argument of a long list names a parameter of a set of 10 to 10000 switches, the time per argument
+// is compared to a linear strcmp scan over the names, which is how parameters used to be found.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+#include "bench.h"
+
+#define MAX_PARAMS 10000
+#define NARGS 100000
+
+static char names[MAX_PARAMS][24];
+static char *args[NARGS + 1];
+
+// Find the name the way the parser did before sets were indexed
+static int linear_search(int nparams, const char *arg){
+    for(int i = 0; i < nparams; i++){
+        if(!strcmp(names[i], arg))
+            return i;
+    }
+    return -1;
+}
+
+int main(void){
+    for(int i = 0; i < MAX_PARAMS; i++)
+        snprintf(names[i], sizeof(names[i]), "--option-%d", i);
+    printf("%8s %14s %14s\n", "params", "hope ns/arg", "linear ns/arg");
+    for(int nparams = 10; nparams <= MAX_PARAMS; nparams *= 10){
+        hope_t hope = hope_init("lookup", NULL);
+        hope_set_t set = hope_init_set("switches");
+        for(int i = 0; i < nparams; i++)
+            hope_add_param(&set, hope_init_param(names[i], NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_NONE));
+        hope_add_set(&hope, set);
+        // the same pseudo-random names for every set size, so only the size of the set changes
+        srand(1);
+        for(int i = 0; i < NARGS; i++)
+            args[i] = names[rand() % nparams];
+        args[NARGS] = NULL;
+
+        double best;
+        int failed = 0;
+        BENCH_BEST(20, best, hope_reset(&hope); failed |= hope_parse(&hope, args));
+        double hope_ns = best / NARGS;
+        volatile int found = 0;
+        // the scan is slow for large sets, fewer arguments are enough to time it
+        int nlinear = nparams >= 1000 ? NARGS / 100 : NARGS;
+        BENCH_BEST(5, best, for(int i = 0; i < nlinear; i++) found += linear_search(nparams, args[i]));
+        printf("%8d %14.1f %14.1f\n", nparams, hope_ns, best / nlinear);
+        hope_free(&hope);
+        if(failed)
+            return 1;
+    }
+    return 0;
+}
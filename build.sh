@@ -3,4 +3,43 @@
 CC=gcc
 CFLAGS="-Wall -Wextra -Werror -pedantic -ggdb"
 
-$CC $CFLAGS -o example example.c
\ No newline at end of file
+case "$1" in
+    test)
+        # every test is a program of its own that exits with 0 if it passed
+        mkdir -p build
+        for test in tests/*.c; do
+            bin=build/$(basename "$test" .c)
+            $CC $CFLAGS -fsanitize=address,undefined -o "$bin" "$test" -pthread || exit 1
+            "./$bin" || exit 1
+        done
+        ;;
+    tsan)
+        mkdir -p build
+        $CC $CFLAGS -O1 -fsanitize=thread -o build/parse_ctx_stress_tsan tests/parse_ctx_stress.c -pthread || exit 1
+        TSAN_OPTIONS=halt_on_error=1 ./build/parse_ctx_stress_tsan || exit 1
+        ;;
+    nomalloc)
+        # the library without malloc: the example has to build and the buffers have to hold what they promise
+        mkdir -p build
+        $CC $CFLAGS -DHOPE_NO_MALLOC -o build/example_no_malloc example.c || exit 1
+        $CC $CFLAGS -fsanitize=address,undefined -o build/no_malloc tests/no_malloc.c || exit 1
+        ./build/no_malloc || exit 1
+        ;;
+    bench)
+        # benchmarks are built with optimizations and without sanitizers, each prints its timings
+        mkdir -p build
+        for bench in bench/*.c; do
+            bin=build/$(basename "$bench" .c)
+            $CC $CFLAGS -O2 -o "$bin" "$bench" || exit 1
+            "./$bin" || exit 1
+        done
+        # the collector against the parser it replaced, the last header before the counting walk (f38e4bf)
+        if git show f38e4bf:hope.h > build/hope_previous.h 2>/dev/null; then
+            $CC $CFLAGS -O2 -DHOPE_BENCH_HEADER='"../build/hope_previous.h"' -o build/collector_previous bench/collector.c || exit 1
+            ./build/collector_previous || exit 1
+        fi
+        ;;
+    *)
+        $CC $CFLAGS -o example example.c
+        ;;
+esac
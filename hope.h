@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,7 +34,31 @@ extern "C" {
 #endif
 #endif
 
-#define HOPE_VERSION "0.1.4"
+#define HOPE_VERSION "0.2.0"
+
+// With HOPE_NO_MALLOC defined, the library never allocates. Sets and the parser hold their parameters
+// in fixed arrays of the sizes below and parsing works in a buffer handed over with hope_set_buffer.
+#ifdef HOPE_NO_MALLOC
+#ifndef HOPE_MAX_PARAMS
+#define HOPE_MAX_PARAMS 32
+#endif
+#ifndef HOPE_MAX_SETS
+#define HOPE_MAX_SETS 8
+#endif
+#endif
+
+// Allocator hooks, define all three before including the header to replace malloc, realloc and free.
+// ctx is the ctx field of the hope_alloc_t the memory belongs to, the sizes are always the exact sizes
+// of the allocation, so sized allocators need no bookkeeping of their own.
+#if defined(HOPE_MALLOC) || defined(HOPE_REALLOC) || defined(HOPE_FREE)
+#if !defined(HOPE_MALLOC) || !defined(HOPE_REALLOC) || !defined(HOPE_FREE)
+#error "HOPE_MALLOC, HOPE_REALLOC and HOPE_FREE must be defined together"
+#endif
+#else
+#define HOPE_MALLOC(ctx, size) ((void)(ctx), malloc(size))
+#define HOPE_REALLOC(ctx, ptr, old_size, size) ((void)(ctx), realloc(ptr, size))
+#define HOPE_FREE(ctx, ptr, size) ((void)(ctx), free(ptr))
+#endif
 
 
 /* individual types of arguments
@@ -58,6 +83,20 @@ HOPEDEF const char *hope_argtype_str(enum hope_argtype_e argtype);
 // Expect zero or one
 #define HOPE_ARGC_OPT       -3
 
+// Parser flags, set them in the flags field of hope_t
+// Replace every @path argument by the arguments in the response file at path
+#define HOPE_FLAG_RESPONSE_FILES 0x01
+// Keep integer and double values as strings while parsing and convert them on the first read
+#define HOPE_FLAG_LAZY           0x02
+// Never print errors of a parse, they are only stored in the error field of the parser or context
+#define HOPE_FLAG_QUIET          0x04
+// Accept unambiguous abbreviations of long parameter names, e.g. --verb for --verbose
+#define HOPE_FLAG_PREFIX         0x08
+// Accept a value attached to a long parameter name with =, e.g. --level=3
+#define HOPE_FLAG_EQUALS         0x10
+// Accept clustered short parameter names, e.g. -xvf for -x -v -f, the last one may take the rest as its value (-ofile)
+#define HOPE_FLAG_CLUSTER        0x20
+
 /* Parameter struct
  * nargs: number of arguments
  *        (0 for no arguments)
@@ -67,17 +106,42 @@ HOPEDEF const char *hope_argtype_str(enum hope_argtype_e argtype);
  * name: prefix for the parameter
  *      (NULL for no prefix, called collector, there can only be one of these)
  * help: help message
+ * has_default: whether the getters read default_value when the parameter was not passed
+ * default_type: the type default_value was set for, it has to match type
+ * default_value: set with the hope_param_default_ functions
  * 
  */
+typedef union {
+    long int integer;
+    double _double;
+    const char *string;
+} hope_default_t;
+
 typedef struct {
     const char *name;
     const char *help;
     enum hope_argtype_e type;
     int nargs; 
+    bool has_default;
+    enum hope_argtype_e default_type;
+    hope_default_t default_value;
 } hope_param_t;
 
+// Initializers of hope_param_t for static parameter arrays, see hope_init_static_set
+#define HOPE_PARAM(n, h, t, argc) { .name = (n), .help = (h), .type = (t), .nargs = (argc) }
+#define HOPE_PARAM_DEFAULT_INTEGER(n, h, argc, value) \
+    { .name = (n), .help = (h), .type = HOPE_TYPE_INTEGER, .nargs = (argc), \
+      .has_default = true, .default_type = HOPE_TYPE_INTEGER, .default_value = { .integer = (value) } }
+#define HOPE_PARAM_DEFAULT_DOUBLE(n, h, argc, value) \
+    { .name = (n), .help = (h), .type = HOPE_TYPE_DOUBLE, .nargs = (argc), \
+      .has_default = true, .default_type = HOPE_TYPE_DOUBLE, .default_value = { ._double = (value) } }
+#define HOPE_PARAM_DEFAULT_STRING(n, h, argc, value) \
+    { .name = (n), .help = (h), .type = HOPE_TYPE_STRING, .nargs = (argc), \
+      .has_default = true, .default_type = HOPE_TYPE_STRING, .default_value = { .string = (value) } }
+
 /* Temporary struct for storing arguments parsed
  * First arg is always the prefix (NULL if no prefix)
+ * raw: the unconverted values of a lazy parse, NULL once they were converted into value
  */
 typedef struct {
     union {
@@ -89,20 +153,256 @@ typedef struct {
     const char *name;
     size_t count;
     enum hope_argtype_e type;
+    const char **raw;
 } hope_result_t;
 
+/* Stable reference to a parameter, handed out when the parameter is added to its set
+ * Getters taking a handle go straight to the result of the parameter instead of searching it by name.
+ * set: the name of the set the parameter belongs to
+ * index: the position of the parameter in the set (HOPE_HANDLE_COLLECTOR for the collector)
+ */
+typedef struct {
+    const char *set;
+    size_t index;
+} hope_handle_t;
+
+#define HOPE_HANDLE_COLLECTOR ((size_t)-1)
+
+/* Allocator the memory of a parser, a context or a set comes from
+ * ctx: passed on to the allocator hooks
+ * calls: allocations and reallocations made so far
+ * bytes: bytes currently allocated
+ * peak: the most bytes that were allocated at once
+ * The counters are only kept when HOPE_ALLOC_STATS is defined.
+ */
+typedef struct {
+    void *ctx;
+    size_t calls;
+    size_t bytes;
+    size_t peak;
+} hope_alloc_t;
+
+/* Slot of the open addressing index over the parameter names of a set
+ * hash: FNV-1a hash of the name
+ * len: length of the name
+ * param: index of the parameter in the set + 1 (0 marks an empty slot)
+ */
+typedef struct {
+    uint64_t hash;
+    size_t len;
+    size_t param;
+} hope_slot_t;
+
 /* A set of parameters. You can have multiple of these in one parser,
  * but only the first matching one will get parsed.
+ * index: hash index over the parameter names, index_cap is always a power of two
+ * param_results: the first result of every parameter in parameter order, the collector's comes last
+ *                (NULL for parameters that were not passed)
+ * alloc: the allocator of params, collector and index (NULL for malloc), e.g. the alloc field of the parser
+ *        the set is added to, it has to stay valid until the parser is freed. Without one the parser the set is
+ *        added to takes the memory over.
+ * param_storage, collector_storage, index_storage: what params, collector and index point into without malloc
+ * is_static: params and collector point into the static array of hope_init_static_set, which the set does not own,
+ *            and there is no index, the names are first checked when the set is compiled
  */
 typedef struct {
     const char *name;
+    bool is_static;
     size_t nparams;
     size_t nresults;
     hope_param_t *params;
     hope_param_t *collector;
     hope_result_t *results;
+    hope_result_t **param_results;
+    hope_slot_t *index;
+    size_t index_cap;
+    hope_alloc_t *alloc;
+#ifdef HOPE_NO_MALLOC
+    hope_param_t param_storage[HOPE_MAX_PARAMS];
+    hope_param_t collector_storage;
+    hope_slot_t index_storage[HOPE_MAX_PARAMS * 4];
+#endif
 } hope_set_t;
 
+/* Parameter record of a compiled set, everything the parser needs to know about a parameter
+ * hash, len: FNV-1a hash and length of the name
+ * size: size of a single value of the parameter's type (0 for switches)
+ * parse: converts a value and stores it in the next free slot of a result (NULL for switches)
+ * absent: what the getters read for the parameter when it was not passed, shared by all parses
+ *         It holds the default value if the parameter has one and no values otherwise.
+ * default_value: the storage absent points into
+ */
+typedef struct {
+    const char *name;
+    const char *help;
+    enum hope_argtype_e type;
+    int nargs;
+    uint64_t hash;
+    size_t len;
+    size_t size;
+    int (*parse)(const char *str, hope_result_t *result);
+    hope_result_t absent;
+    hope_default_t default_value;
+} hope_table_param_t;
+
+/* Node of the trie over the long parameter names of a compiled set (those starting with --)
+ * The root stands for the leading -- and every other node for one more character of a name.
+ * c: the character leading to the node, the children of a node are ordered by it
+ * child: index of the first child (0 if there is none, the root is never a child)
+ * sibling: index of the next child of the same parent (0 if there is none)
+ * param: index of the parameter + 1 if all names below the node belong to the same parameter,
+ *        HOPE_TRIE_AMBIGUOUS if they belong to several
+ * end: index of the parameter + 1 whose name ends at the node (0 if none does)
+ */
+typedef struct {
+    uint32_t child;
+    uint32_t sibling;
+    uint32_t param;
+    uint32_t end;
+    unsigned char c;
+} hope_trie_node_t;
+
+#define HOPE_TRIE_AMBIGUOUS UINT32_MAX
+
+/* A compiled set, read-only once built
+ * params: the parameter records in parameter order, the collector's record follows them
+ * index: hash index over the parameter names, index_cap is always a power of two
+ * required: bitmask of the parameters that have to be passed
+ * first_chars: bitmap of the first characters of the parameter names
+ * max_len: length of the longest parameter name
+ * Arguments that start with another character or are longer are rejected without hashing them.
+ * needs_args: whether the set can not match an empty argument list
+ * trie: the trie resolving abbreviations of the long names, its root comes first
+ * duplicate: a name the parameters of a static set hold twice (NULL if there is none), hope_add_param rejects them
+ *            for the other sets
+ */
+typedef struct {
+    const char *name;
+    size_t nparams;
+    const hope_table_param_t *params;
+    const hope_table_param_t *collector;
+    const hope_slot_t *index;
+    size_t index_cap;
+    const uint64_t *required;
+    const hope_trie_node_t *trie;
+    uint64_t first_chars[4];
+    size_t max_len;
+    bool needs_args;
+    const char *duplicate;
+} hope_table_set_t;
+
+/* Parser table built by hope_compile, a single allocation holding all compiled sets
+ * size: bytes of the allocation
+ * first_chars, max_len: the union of the name filters of all sets
+ * numeric_names: whether a parameter name looks like a number, otherwise arguments that do are never looked up
+ */
+typedef struct {
+    size_t size;
+    size_t nsets;
+    const hope_table_set_t *sets;
+    uint64_t first_chars[4];
+    size_t max_len;
+    bool numeric_names;
+} hope_table_t;
+
+/* Classification of an argument, made once per parse and shared by the walks of all sets
+ * hash: FNV-1a hash of the argument, only set for candidates
+ * len: length of the argument, only set for candidates
+ * run: for an argument that can only be a value, the amount of such arguments in a row starting with it (0 otherwise)
+ * kind: HOPE_TOKEN_ bits
+ */
+typedef struct {
+    uint64_t hash;
+    size_t len;
+    size_t run;
+    unsigned kind;
+} hope_token_t;
+
+// May be a parameter name of some set, it passed the name filters of the table and its hash is set
+#define HOPE_TOKEN_CANDIDATE 0x01
+// The -- separator
+#define HOPE_TOKEN_SEPARATOR 0x02
+// Starts with a single -, e.g. a short name or a cluster of them
+#define HOPE_TOKEN_SHORT     0x04
+// Starts with -- followed by more, e.g. a long name, an abbreviation of one or --name=value
+#define HOPE_TOKEN_LONG      0x08
+// Looks like a number, e.g. -5, +1 or .5
+#define HOPE_TOKEN_NUMERIC   0x10
+
+
+/* A block of the arena, the memory handed out follows the header
+ * size: usable bytes in the block
+ * used: bytes handed out so far
+ */
+typedef struct hope_arena_block_s {
+    struct hope_arena_block_s *next;
+    size_t size;
+    size_t used;
+} hope_arena_block_t;
+
+/* Bump allocator backing all results of a parse
+ * Everything in it is released at once by hope_free
+ * head: the block allocations are currently served from
+ * alloc: where the blocks come from, the owner of the arena points it at its own allocator before using it
+ * Without malloc the only block is the buffer handed over by the caller.
+ */
+typedef struct {
+    hope_arena_block_t *head;
+    hope_alloc_t *alloc;
+} hope_arena_t;
+
+/* A response file read while expanding the arguments, the arguments point into its data
+ * data: the file contents, tokenized in place
+ * size: size of the file
+ * cap: bytes of data that may be written, the mapping extends to the end of its last page
+ */
+typedef struct hope_mapping_s {
+    struct hope_mapping_s *next;
+    char *data;
+    size_t size;
+    size_t cap;
+} hope_mapping_t;
+
+/* A single value handed to a stream callback by hope_parse_stream
+ * name: the name of the parameter (NULL for the collector)
+ * index: the position of the parameter in its set, like the index of its handle (HOPE_HANDLE_COLLECTOR for the collector)
+ * value: the converted value, the member matching type is set
+ */
+typedef struct {
+    const char *name;
+    size_t index;
+    enum hope_argtype_e type;
+    union {
+        long int integer;
+        double _double;
+        const char *string;
+        bool _switch;
+    } value;
+} hope_value_t;
+
+/* What made the last parse of a parser or context fail, recorded without formatting any text
+ * code: the error code (HOPE_SUCCESS_CODE after a successful parse). When no set matched,
+ *       it is the reason of the set that got furthest, while the parse returns HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE.
+ * arg: position of the argument that caused the error in the arguments parsed, after response files were expanded
+ *      (for hope_read_fd the position of the value in the input, HOPE_ERROR_NO_ARG if no single argument did)
+ * param: name of the parameter involved ("<collector>" for the collector, NULL for none)
+ * set: name of the set the error occurred in (NULL if it did not occur in a set)
+ * value: the argument or response file that caused the error (NULL if none)
+ * The strings point into the arguments and the parser, hope_format_error turns the error into text.
+ */
+typedef struct {
+    int code;
+    size_t arg;
+    const char *param;
+    const char *set;
+    const char *value;
+} hope_error_t;
+
+#define HOPE_ERROR_NO_ARG ((size_t)-1)
+
+// Receives every value of a streamed parse, anything but HOPE_SUCCESS_CODE stops the parse and is returned by it
+// without being reported as an error
+typedef int (*hope_stream_cb_t)(const hope_value_t *value, void *user);
 
 /* Main data structure, will contain the parameters and
  * further information about the arguments parsed
@@ -112,6 +412,17 @@ typedef struct {
  * nsets: The amount of sets
  * results: A pointer to the result array for the used set
  * nresults: A pointer to the amount of results for the used set
+ * param_results: The results of the used set in parameter order (NULL for parameters that were not passed)
+ * used_set: The index of the used set
+ * arena: The memory all results and their values are allocated from
+ * table: The compiled sets, built by hope_compile or the first parse
+ * flags: HOPE_FLAG_ values changing how arguments are parsed
+ * mappings: The response files the results may point into
+ * alloc: The allocator of the sets, the table and the arena
+ * error: Why the last parse failed
+ * help, help_len: The help message, rendered once by hope_print_help for a terminal of help_width columns
+ * set_storage: what sets points into without malloc
+ * buffer, buffer_size: without malloc, the memory the table and the arena live in
  */ 
 typedef struct {
     const char *prog_name;
@@ -120,9 +431,48 @@ typedef struct {
     size_t nsets;
     hope_result_t *results;
     size_t nresults;
+    hope_result_t **param_results;
+    size_t used_set;
     const char *used_set_name;
+    hope_arena_t arena;
+    hope_table_t *table;
+    unsigned flags;
+    hope_mapping_t *mappings;
+    hope_alloc_t alloc;
+    hope_error_t error;
+    char *help;
+    size_t help_len;
+    size_t help_width;
+#ifdef HOPE_NO_MALLOC
+    hope_set_t set_storage[HOPE_MAX_SETS];
+    void *buffer;
+    size_t buffer_size;
+#endif
 } hope_t;
 
+/* Per-call parsing state, it owns everything a parse produces
+ * Any number of contexts can parse against the same compiled parser at once without locking,
+ * as long as the parser itself is not changed meanwhile.
+ * hope: The parser to parse with, it is only read
+ * results, nresults, param_results, used_set, used_set_name: as in hope_t
+ * arena: The memory the results of this context are allocated from
+ * mappings: The response files the results of this context may point into
+ * alloc: The allocator of the arena, its ctx is taken from the parser and it counts for this context only
+ * error: Why the last parse into this context failed
+ */
+typedef struct {
+    const hope_t *hope;
+    hope_result_t *results;
+    size_t nresults;
+    hope_result_t **param_results;
+    size_t used_set;
+    const char *used_set_name;
+    hope_arena_t arena;
+    hope_mapping_t *mappings;
+    hope_alloc_t alloc;
+    hope_error_t error;
+} hope_parse_ctx_t;
+
 
 //
 // hope_param_t functions
@@ -130,6 +480,10 @@ typedef struct {
 
 // Initialize the hope_param_t data structure
 HOPEDEF hope_param_t hope_init_param(const char *name, const char *help, enum hope_argtype_e type, int nargs);
+// Give the parameter a default value, which the getters return when it was not passed
+HOPEDEF hope_param_t hope_param_default_integer(hope_param_t param, long int value);
+HOPEDEF hope_param_t hope_param_default_double(hope_param_t param, double value);
+HOPEDEF hope_param_t hope_param_default_string(hope_param_t param, const char *value);
 
 //
 // hope_set_t functions
@@ -137,9 +491,15 @@ HOPEDEF hope_param_t hope_init_param(const char *name, const char *help, enum ho
 
 // Initialize a new set
 HOPEDEF hope_set_t hope_init_set(const char *set_name);
+// Initialize a set from a static array of nparams parameters, the collector (if any) has to be the last one
+// The array is not copied and has to outlive the parser, hope_add_set checks it and duplicate names fail the first compile
+HOPEDEF hope_set_t hope_init_static_set(const char *set_name, const hope_param_t *params, size_t nparams);
+#define HOPE_INIT_STATIC_SET(set_name, params) hope_init_static_set((set_name), (params), sizeof(params) / sizeof((params)[0]))
 
 // Add a new parameter to the set
 HOPEDEF int hope_add_param(hope_set_t *set, hope_param_t param);
+// Add a new parameter to the set and store a handle for it, which stays valid for the lifetime of the set
+HOPEDEF int hope_add_param_handle(hope_set_t *set, hope_param_t param, hope_handle_t *handle);
 
 //
 // hope_t functions
@@ -149,16 +509,86 @@ HOPEDEF int hope_add_param(hope_set_t *set, hope_param_t param);
 HOPEDEF hope_t hope_init(const char *prog_name, const char *prog_desc);
 // Free the params in the hope data structure
 HOPEDEF void hope_free(hope_t *hope);
+// Drop the results and the error of previous parses, but keep the sets, the table and the memory for the next parse
+HOPEDEF void hope_reset(hope_t *hope);
 // Generate and write the help message to the sink
 HOPEDEF void hope_print_help(hope_t *hope, FILE *sink); 
+
+// Get the message of an error code
+HOPEDEF const char *hope_error_str(int code);
+
+// Write the message of the error into buf, returns the length of the whole message like snprintf
+HOPEDEF int hope_format_error(const hope_error_t *error, char *buf, size_t size);
 // Add a new parameter set to the hope data structure
 HOPEDEF int hope_add_set(hope_t *hope, hope_set_t set);
-// Parse the command line arguments for the given set
-HOPEDEF int hope_parse_set(hope_set_t *set, char *args[]);
+// Compile the sets into the read-only table all parses run against
+// Adding a set afterwards drops the table, it is then rebuilt by the next parse
+HOPEDEF int hope_compile(hope_t *hope);
+// Get the amount of memory compiling the parser and parsing argc arguments with it takes at most
+HOPEDEF size_t hope_required_bytes(const hope_t *hope, size_t argc);
+#ifdef HOPE_NO_MALLOC
+// Hand the memory the table and the results are placed in to the parser, it has to outlive the parser
+// Use hope_required_bytes to size it, once the sets were added
+HOPEDEF void hope_set_buffer(hope_t *hope, void *buf, size_t size);
+#endif
+// Parse the command line arguments for the given set, the results are allocated from the hope data structure
+// (since 0.2.0, the set used to be parsed on its own)
+HOPEDEF int hope_parse_set(hope_t *hope, hope_set_t *set, char *args[]);
 // Parse all sets and use the results from the first one
 HOPEDEF int hope_parse(hope_t *hope, char *args[]);
 // A helper function that allows to you just pass argv for parsing
 HOPEDEF inline int hope_parse_argv(hope_t *hope, char *argv[]);
+// Parse the arguments for the set with the given name and pass every value to cb as soon as it is read,
+// no results are stored
+HOPEDEF int hope_parse_stream(hope_t *hope, const char *set_name, char *args[], hope_stream_cb_t cb, void *user);
+// Read values separated by delim from the file descriptor fd until its end and pass them to the collector
+// of the set that was parsed last. They are added to its results, or handed to cb as they arrive if it is not NULL
+HOPEDEF int hope_read_fd(hope_t *hope, int fd, char delim, hope_stream_cb_t cb, void *user);
+// Write the completions of word to the sink, one per line, args are the arguments before it
+HOPEDEF int hope_complete(hope_t *hope, char *args[], const char *word, FILE *sink);
+// If argv[1] is HOPE_COMPLETE_ARG, write the completions of the last argument to the sink and return true
+HOPEDEF bool hope_complete_argv(hope_t *hope, char *argv[], FILE *sink);
+// Write the completion script for the shell ("bash", "zsh" or "fish") to the sink
+HOPEDEF int hope_print_completion_script(const hope_t *hope, const char *shell, FILE *sink);
+
+//
+// hope_parse_ctx_t functions
+//
+
+// Create a context for parsing with the parser, which has to be compiled with hope_compile first
+HOPEDEF hope_parse_ctx_t hope_init_parse_ctx(const hope_t *hope);
+// Free the results of the context
+HOPEDEF void hope_free_parse_ctx(hope_parse_ctx_t *ctx);
+// Drop the results and the error of the context, but keep its memory for the next parse
+HOPEDEF void hope_reset_parse_ctx(hope_parse_ctx_t *ctx);
+// Parse the arguments into the context
+HOPEDEF int hope_parse_ctx(hope_parse_ctx_t *ctx, char *args[]);
+#ifdef HOPE_NO_MALLOC
+// Hand the memory the results are placed in to the context, hope_required_bytes is enough for it as well
+HOPEDEF void hope_set_ctx_buffer(hope_parse_ctx_t *ctx, void *buf, size_t size);
+#endif
+
+// The getters behave like their hope_t counterparts, but read the results of the context.
+// They write to it, a lazy value is converted in place and a failing getter stores its error in the context.
+HOPEDEF int hope_ctx_get_switch(hope_parse_ctx_t *ctx, const char *name, bool *dest);
+HOPEDEF int hope_ctx_get_integer(hope_parse_ctx_t *ctx, const char *name, long int **dest);
+HOPEDEF int hope_ctx_get_double(hope_parse_ctx_t *ctx, const char *name, double **dest);
+HOPEDEF int hope_ctx_get_string(hope_parse_ctx_t *ctx, const char *name, const char ***dest);
+
+HOPEDEF bool hope_ctx_get_single_switch(hope_parse_ctx_t *ctx, const char *name);
+HOPEDEF long int hope_ctx_get_single_integer(hope_parse_ctx_t *ctx, const char *name);
+HOPEDEF double hope_ctx_get_single_double(hope_parse_ctx_t *ctx, const char *name);
+HOPEDEF const char *hope_ctx_get_single_string(hope_parse_ctx_t *ctx, const char *name);
+
+HOPEDEF int hope_ctx_get_switch_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, bool *dest);
+HOPEDEF int hope_ctx_get_integer_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, long int **dest);
+HOPEDEF int hope_ctx_get_double_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, double **dest);
+HOPEDEF int hope_ctx_get_string_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, const char ***dest);
+
+HOPEDEF bool hope_ctx_get_single_switch_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle);
+HOPEDEF long int hope_ctx_get_single_integer_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle);
+HOPEDEF double hope_ctx_get_single_double_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle);
+HOPEDEF const char *hope_ctx_get_single_string_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle);
 
 // All these getter functions return -1 on error, and print an error message to stderr
 // Dest pointers will also be set to NULL on error
@@ -188,6 +618,36 @@ HOPEDEF double hope_get_single_double(hope_t *hope, const char *name);
 // Get a single string or return a default value if none were passed.
 HOPEDEF const char *hope_get_single_string(hope_t *hope, const char *name);
 
+// These getters work like the ones above, but take the handle of the parameter instead of its name.
+// This avoids the name lookup, which makes them the better choice for repeated reads.
+// They fail if the handle belongs to a set other than the one that was parsed.
+
+HOPEDEF int hope_get_switch_by_handle(hope_t *hope, hope_handle_t handle, bool *dest);
+HOPEDEF int hope_get_integer_by_handle(hope_t *hope, hope_handle_t handle, long int **dest);
+HOPEDEF int hope_get_double_by_handle(hope_t *hope, hope_handle_t handle, double **dest);
+HOPEDEF int hope_get_string_by_handle(hope_t *hope, hope_handle_t handle, const char ***dest);
+
+HOPEDEF bool hope_get_single_switch_by_handle(hope_t *hope, hope_handle_t handle);
+HOPEDEF long int hope_get_single_integer_by_handle(hope_t *hope, hope_handle_t handle);
+HOPEDEF double hope_get_single_double_by_handle(hope_t *hope, hope_handle_t handle);
+HOPEDEF const char *hope_get_single_string_by_handle(hope_t *hope, hope_handle_t handle);
+
+// Pick the handle getter from the type of dest, so passing a destination of the wrong type fails to compile
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define hope_get(hope, handle, dest) _Generic((dest), \
+        bool *: hope_get_switch_by_handle, \
+        long int **: hope_get_integer_by_handle, \
+        double **: hope_get_double_by_handle, \
+        const char ***: hope_get_string_by_handle \
+    )((hope), (handle), (dest))
+#define hope_ctx_get(ctx, handle, dest) _Generic((dest), \
+        bool *: hope_ctx_get_switch_by_handle, \
+        long int **: hope_ctx_get_integer_by_handle, \
+        double **: hope_ctx_get_double_by_handle, \
+        const char ***: hope_ctx_get_string_by_handle \
+    )((ctx), (handle), (dest))
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -202,6 +662,23 @@ HOPEDEF const char *hope_get_single_string(hope_t *hope, const char *name);
 #include <assert.h>
 #include <string.h>
 #include <stdarg.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <locale.h>
+#include <ctype.h>
+#include <errno.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HOPE_POSIX 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#endif
 
 // Get the string representation of an argument type
 HOPEDEF const char *hope_argtype_str(enum hope_argtype_e argtype) {
@@ -219,24 +696,49 @@ HOPEDEF const char *hope_argtype_str(enum hope_argtype_e argtype) {
     }
 }
 
+// Check that the type is one of the HOPE_TYPE_ values, parameters of any other type are never added to a set
+bool hope_argtype_valid(enum hope_argtype_e argtype){
+    return (unsigned)argtype <= HOPE_TYPE_STRING;
+}
+
 // generic format string
 
 #define HOPE_SUCCESS_CODE 0x00
 #define HOPE_FMT_DEFAULT "hope: %s; %s"
 
+// Print an error message to stderr, with HOPE_QUIET defined nothing is ever printed
+void hope_eprintf(const char *fmt, ...){
+    #ifdef HOPE_QUIET
+    (void)fmt;
+    #else
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    #endif
+}
+
 // Error codes for system failures
 #define HOPE_ERR_CODE 0x10
 #define HOPE_ERR_ALLOC_FAILED_CODE 0x11
+// Without malloc the only memory that can run out is the buffer of the caller
+#define HOPE_ERR_CAPACITY_CODE HOPE_ERR_ALLOC_FAILED_CODE
+#ifdef HOPE_NO_MALLOC
+#define HOPE_ERR_ALLOC_FAILED_MSG "Buffer capacity exhausted"
+#else
 #define HOPE_ERR_ALLOC_FAILED_MSG "Allocation of memory failed"
+#endif
 #define HOPE_ERR_INVALID_STRUCT_CODE 0x12
 #define HOPE_ERR_INVALID_STRUCT_MSG "Invalid hope structure passed"
+#define HOPE_ERR_UNKNOWN_SHELL_CODE 0x13
+#define HOPE_ERR_UNKNOWN_SHELL_MSG "No completion script for this shell"
 
 void hope_err_alloc(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT "\n", msg, HOPE_ERR_ALLOC_FAILED_MSG);
+    hope_eprintf(HOPE_FMT_DEFAULT "\n", msg, HOPE_ERR_ALLOC_FAILED_MSG);
 }
 
 void hope_err_invalid_struct(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT "\n", msg, HOPE_ERR_INVALID_STRUCT_MSG);
+    hope_eprintf(HOPE_FMT_DEFAULT "\n", msg, HOPE_ERR_INVALID_STRUCT_MSG);
 }
 
 void hope_sys_err_any(int err, const char *msg){
@@ -258,28 +760,52 @@ void hope_sys_err_any(int err, const char *msg){
 #define HOPE_PARAMADD_ERR_HASCOLLECTOR_MSG "Collector already exists"
 #define HOPE_PARAMADD_ERR_DUPLICATE_CODE 0x22
 #define HOPE_PARAMADD_ERR_DUPLICATE_MSG "Duplicate parameter name"
+#define HOPE_PARAMADD_ERR_DEFAULT_TYPE_CODE 0x23
+#define HOPE_PARAMADD_ERR_DEFAULT_TYPE_MSG "Default value does not match the parameter type"
+#define HOPE_PARAMADD_ERR_TYPE_CODE 0x24
+#define HOPE_PARAMADD_ERR_TYPE_MSG "Invalid parameter type"
 
 void hope_paramadd_err_hascollector(){
-    fprintf(stderr, HOPE_FMT_DEFAULT "\n", 
+    hope_eprintf(HOPE_FMT_DEFAULT "\n", 
             HOPE_PARAMADD_ERR_GENERIC_MSG, 
             HOPE_PARAMADD_ERR_HASCOLLECTOR_MSG);
 }
 
 void hope_paramadd_err_duplicate(const char *name) {
-    fprintf(stderr, HOPE_FMT_DEFAULT ": %s\n", 
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n", 
             HOPE_PARAMADD_ERR_GENERIC_MSG, 
             HOPE_PARAMADD_ERR_DUPLICATE_MSG,
             name);
 }
 
+void hope_paramadd_err_default_type(const char *name) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n", 
+            HOPE_PARAMADD_ERR_GENERIC_MSG, 
+            HOPE_PARAMADD_ERR_DEFAULT_TYPE_MSG,
+            name ? name : "<collector>");
+}
+
+void hope_paramadd_err_type(const char *name) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n", 
+            HOPE_PARAMADD_ERR_GENERIC_MSG, 
+            HOPE_PARAMADD_ERR_TYPE_MSG,
+            name ? name : "<collector>");
+}
+
 void hope_paramadd_err_any(int err, const char *msg) {
     switch(err) {
         case HOPE_PARAMADD_ERR_DUPLICATE_CODE:
             hope_paramadd_err_duplicate(msg);
             return;
+        case HOPE_PARAMADD_ERR_DEFAULT_TYPE_CODE:
+            hope_paramadd_err_default_type(msg);
+            return;
         case HOPE_PARAMADD_ERR_HASCOLLECTOR_CODE:
             hope_paramadd_err_hascollector();
             return;
+        case HOPE_PARAMADD_ERR_TYPE_CODE:
+            hope_paramadd_err_type(msg);
+            return;
     }
     return;
 }
@@ -294,34 +820,74 @@ void hope_paramadd_err_any(int err, const char *msg) {
 #define HOPE_PARSE_ERR_PARAM_UNPARSABLE_MSG "Parameter could not be parsed"
 #define HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE 0x33
 #define HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_MSG "Invalid amount of arguments passed for parameter"
+#define HOPE_PARSE_ERR_PARAM_RANGE_CODE 0x34
+#define HOPE_PARSE_ERR_PARAM_RANGE_MSG "Value out of range"
+#define HOPE_PARSE_ERR_RESPONSE_FILE_CODE 0x35
+#define HOPE_PARSE_ERR_RESPONSE_FILE_MSG "Response file could not be read"
+#define HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE 0x36
+#define HOPE_PARSE_ERR_RESPONSE_CYCLE_MSG "Response files include each other"
+#define HOPE_PARSE_ERR_INPUT_CODE 0x37
+#define HOPE_PARSE_ERR_INPUT_MSG "Input could not be read"
+#define HOPE_PARSE_ERR_NO_SET_CODE 0x38
+#define HOPE_PARSE_ERR_NO_SET_MSG "No set with the given name"
+#define HOPE_PARSE_ERR_AMBIGUOUS_CODE 0x39
+#define HOPE_PARSE_ERR_AMBIGUOUS_MSG "Abbreviation matches more than one parameter"
 
 void hope_parse_err(const char *msg){
-    fprintf(stderr, HOPE_FMT_DEFAULT "\n",
+    hope_eprintf(HOPE_FMT_DEFAULT "\n",
             HOPE_PARSE_ERR_GENERIC_MSG,
             msg);
 }
 
 void hope_parse_err_param_miscount(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT "; %s\n",
+    hope_eprintf(HOPE_FMT_DEFAULT "; %s\n",
             HOPE_PARSE_ERR_GENERIC_MSG,
             HOPE_PARSE_ERR_PARAM_MISCOUNT_MSG,
             msg);
 }
 
 void hope_parse_err_param_unparsable(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT ": %s\n",
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
             HOPE_PARSE_ERR_GENERIC_MSG,
             HOPE_PARSE_ERR_PARAM_UNPARSABLE_MSG,
             msg);
 }
 
 void hope_parse_err_param_arg_miscount(const char *name) {
-    fprintf(stderr, HOPE_FMT_DEFAULT " %s\n",
+    hope_eprintf(HOPE_FMT_DEFAULT " %s\n",
                 HOPE_PARSE_ERR_GENERIC_MSG,
                 HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_MSG,
                 name);
 }
 
+void hope_parse_err_param_range(const char *msg) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
+            HOPE_PARSE_ERR_GENERIC_MSG,
+            HOPE_PARSE_ERR_PARAM_RANGE_MSG,
+            msg);
+}
+
+void hope_parse_err_response_file(const char *path) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
+            HOPE_PARSE_ERR_GENERIC_MSG,
+            HOPE_PARSE_ERR_RESPONSE_FILE_MSG,
+            path);
+}
+
+void hope_parse_err_response_cycle(const char *path) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
+            HOPE_PARSE_ERR_GENERIC_MSG,
+            HOPE_PARSE_ERR_RESPONSE_CYCLE_MSG,
+            path);
+}
+
+void hope_parse_err_input(const char *msg) {
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
+            HOPE_PARSE_ERR_GENERIC_MSG,
+            HOPE_PARSE_ERR_INPUT_MSG,
+            msg);
+}
+
 void hope_parse_err_any(int err, const char *msg){
     switch(err){
         case HOPE_PARSE_ERR_CODE:
@@ -336,6 +902,18 @@ void hope_parse_err_any(int err, const char *msg){
         case HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE:
             hope_parse_err_param_arg_miscount(msg);
             return;
+        case HOPE_PARSE_ERR_PARAM_RANGE_CODE:
+            hope_parse_err_param_range(msg);
+            return;
+        case HOPE_PARSE_ERR_RESPONSE_FILE_CODE:
+            hope_parse_err_response_file(msg);
+            return;
+        case HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE:
+            hope_parse_err_response_cycle(msg);
+            return;
+        case HOPE_PARSE_ERR_INPUT_CODE:
+            hope_parse_err_input(msg);
+            return;
     }
 }
 
@@ -355,14 +933,14 @@ void hope_parse_err_any(int err, const char *msg){
 #define HOPE_GET_ERR_TYPE_MISMATCH_MSG "Type mismatch;"
 
 void hope_get_err_noexist(const char *msg){
-    fprintf(stderr, HOPE_FMT_DEFAULT ": %s\n",
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n",
             HOPE_GET_ERR_GENERIC_MSG,
             HOPE_GET_ERR_NOEXIST_MSG,
             msg);
 }
 
 void hope_get_err_type_mismatch(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT " %s\n",
+    hope_eprintf(HOPE_FMT_DEFAULT " %s\n",
             HOPE_GET_ERR_GENERIC_MSG,
             HOPE_GET_ERR_TYPE_MISMATCH_MSG,
             msg);
@@ -388,7 +966,7 @@ void hope_get_err_any(int err, const char *msg){
 #define HOPE_SETADD_ERR_DUPLICATE_MSG "A set with the same name already exists"
 
 void hope_setadd_err_duplicate(const char *msg) {
-    fprintf(stderr, HOPE_FMT_DEFAULT ": %s\n", 
+    hope_eprintf(HOPE_FMT_DEFAULT ": %s\n", 
             HOPE_SETADD_ERR_GENERIC_MSG, 
             HOPE_SETADD_ERR_DUPLICATE_MSG,
             msg);
@@ -403,41 +981,6 @@ void hope_setadd_err_any(int err, const char *msg) {
     return;
 }
 
-// a function to concatenate strings given in varargs
-char *varstrcat(int count, ...)
-{
-    va_list ap;
-    size_t  len = 0;
-
-    if (count < 1)
-        return NULL;
-
-    // First, measure the total length required.
-    va_start(ap, count);
-    for (int i=0; i < count; i++) {
-        const char *s = va_arg(ap, char *);
-        len += strlen(s);
-    }
-    va_end(ap);
-
-    // Allocate return buffer.
-    char *ret = malloc(len + 1);
-    if (ret == NULL)
-        return NULL;
-
-    // Concatenate all the strings into the return buffer.
-    char *dst = ret;
-    va_start(ap, count);
-    for (int i=0; i < count; i++) {
-        const char *src = va_arg(ap, char *);
-
-        // This loop is a strcpy.
-        strcpy(dst, src);
-    }
-    va_end(ap);
-    return ret;
-}
-
 
 // This is a bit ugly, but it can count the variadic function count
 #ifdef _MSC_VER // Microsoft compilers
@@ -460,30 +1003,21 @@ char *varstrcat(int count, ...)
 #define hope_err_any(err, ...) (_hope_err_any((err), GET_ARG_COUNT(__VA_ARGS__), __VA_ARGS__))
 void _hope_err_any(int err, int count, ...){
     va_list ap;
-    size_t  len = 0;
-
-    // First, measure the total length required.
-    va_start(ap, count);
-    for (int i=0; i < count; i++) {
-        const char *s = va_arg(ap, char *);
-        len += strlen(s);
-    }
-    va_end(ap);
-
-    // Allocate return buffer.
-    char *msg = malloc(len + 1);
-    assert(msg);
+    // messages are concatenated on the stack, so reporting an error never allocates, longer ones are cut off
+    char msg[256];
+    size_t len = 0;
 
-    // Concatenate all the strings into the return buffer.
-    char *dst = msg;
     va_start(ap, count);
     for (int i=0; i < count; i++) {
         const char *src = va_arg(ap, char *);
-
-        // This loop is a strcpy.
-        strcpy(dst, src);
+        size_t src_len = strlen(src);
+        if(src_len > sizeof(msg) - 1 - len)
+            src_len = sizeof(msg) - 1 - len;
+        memcpy(msg + len, src, src_len);
+        len += src_len;
     }
     va_end(ap);
+    msg[len] = '\0';
 
     switch(err & 0xF0){
         case HOPE_ERR_CODE:
@@ -504,550 +1038,3417 @@ void _hope_err_any(int err, int count, ...){
     }
 }
 
+HOPEDEF const char *hope_error_str(int code){
+    switch(code){
+        case HOPE_SUCCESS_CODE: return "Success";
+        case HOPE_ERR_ALLOC_FAILED_CODE: return HOPE_ERR_ALLOC_FAILED_MSG;
+        case HOPE_ERR_INVALID_STRUCT_CODE: return HOPE_ERR_INVALID_STRUCT_MSG;
+        case HOPE_ERR_UNKNOWN_SHELL_CODE: return HOPE_ERR_UNKNOWN_SHELL_MSG;
+        case HOPE_PARAMADD_ERR_HASCOLLECTOR_CODE: return HOPE_PARAMADD_ERR_HASCOLLECTOR_MSG;
+        case HOPE_PARAMADD_ERR_DUPLICATE_CODE: return HOPE_PARAMADD_ERR_DUPLICATE_MSG;
+        case HOPE_PARAMADD_ERR_DEFAULT_TYPE_CODE: return HOPE_PARAMADD_ERR_DEFAULT_TYPE_MSG;
+        case HOPE_PARAMADD_ERR_TYPE_CODE: return HOPE_PARAMADD_ERR_TYPE_MSG;
+        case HOPE_PARSE_ERR_CODE: return HOPE_PARSE_ERR_GENERIC_MSG;
+        case HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE: return HOPE_PARSE_ERR_PARAM_MISCOUNT_MSG;
+        case HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE: return HOPE_PARSE_ERR_PARAM_UNPARSABLE_MSG;
+        case HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE: return HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_MSG;
+        case HOPE_PARSE_ERR_PARAM_RANGE_CODE: return HOPE_PARSE_ERR_PARAM_RANGE_MSG;
+        case HOPE_PARSE_ERR_RESPONSE_FILE_CODE: return HOPE_PARSE_ERR_RESPONSE_FILE_MSG;
+        case HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE: return HOPE_PARSE_ERR_RESPONSE_CYCLE_MSG;
+        case HOPE_PARSE_ERR_INPUT_CODE: return HOPE_PARSE_ERR_INPUT_MSG;
+        case HOPE_PARSE_ERR_NO_SET_CODE: return HOPE_PARSE_ERR_NO_SET_MSG;
+        case HOPE_PARSE_ERR_AMBIGUOUS_CODE: return HOPE_PARSE_ERR_AMBIGUOUS_MSG;
+        case HOPE_GET_ERR_NOEXIST_CODE: return HOPE_GET_ERR_NOEXIST_MSG;
+        case HOPE_GET_ERR_TYPE_MISMATCH_CODE: return HOPE_GET_ERR_TYPE_MISMATCH_MSG;
+        case HOPE_SETADD_ERR_DUPLICATE_CODE: return HOPE_SETADD_ERR_DUPLICATE_MSG;
+        // e.g. a code returned by a stream callback
+        default: return "Unknown error";
+    }
+}
 
-//
-// hope_param_t functions
-//
+// Append to the message in buf, len counts the whole message even once buf is full
+void hope_format_append(char *buf, size_t size, size_t *len, const char *fmt, ...){
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(*len < size ? buf + *len : NULL, *len < size ? size - *len : 0, fmt, ap);
+    va_end(ap);
+    if(n > 0)
+        *len += (size_t)n;
+}
 
-// Initialize the hope data structure
-HOPEDEF hope_param_t hope_init_param(const char *name, const char *help, enum hope_argtype_e type, int nargs){
-    hope_param_t param = {
-        .name = name,
-        .help = help,
-        .type = type,
-        .nargs = nargs,
-    };
-    return param;
+HOPEDEF int hope_format_error(const hope_error_t *error, char *buf, size_t size){
+    size_t len = 0;
+    if(size > 0)
+        buf[0] = '\0';
+    hope_format_append(buf, size, &len, "%s", hope_error_str(error->code));
+    if(error->param)
+        hope_format_append(buf, size, &len, ": %s", error->param);
+    if(error->value)
+        hope_format_append(buf, size, &len, error->param ? " '%s'" : ": '%s'", error->value);
+    if(error->arg != HOPE_ERROR_NO_ARG && error->set)
+        hope_format_append(buf, size, &len, " (argument %lu of set %s)", (unsigned long)error->arg, error->set);
+    else if(error->arg != HOPE_ERROR_NO_ARG)
+        hope_format_append(buf, size, &len, " (argument %lu)", (unsigned long)error->arg);
+    else if(error->set)
+        hope_format_append(buf, size, &len, " (set %s)", error->set);
+    return (int)len;
+}
+
+// Store the error of a failed parse and print it, unless the parser is quiet
+void hope_report_error(unsigned flags, hope_error_t *dest, hope_error_t error){
+    *dest = error;
+    if(flags & HOPE_FLAG_QUIET)
+        return;
+    // formatted on the stack, so reporting an error never allocates
+    char msg[256];
+    hope_format_error(&error, msg, sizeof(msg));
+    hope_eprintf(HOPE_FMT_DEFAULT "\n", HOPE_PARSE_ERR_GENERIC_MSG, msg);
 }
 
+
 //
-// hope_set_t functions
+// Allocation
 //
 
-HOPEDEF hope_set_t hope_init_set(const char *set_name){
-    return (hope_set_t) {
-        .name = set_name,
-        .nparams = 0,
-        .params = NULL,
-        .collector = NULL,
-        .results = NULL,
-        .nresults = 0
-    };
+#ifndef HOPE_NO_MALLOC
+// Allocate through the hooks and count the allocation in alloc (NULL for plain malloc)
+void *hope_malloc(hope_alloc_t *alloc, size_t size){
+    void *ptr = HOPE_MALLOC(alloc ? alloc->ctx : NULL, size);
+    #ifdef HOPE_ALLOC_STATS
+    if(ptr && alloc){
+        alloc->calls++;
+        alloc->bytes += size;
+        if(alloc->bytes > alloc->peak)
+            alloc->peak = alloc->bytes;
+    }
+    #endif
+    return ptr;
 }
 
-// Add a new parameter to the set
-HOPEDEF int hope_add_param(hope_set_t *set, hope_param_t param){
-    if(param.name == NULL){
-        if(set->collector != NULL){
-            hope_paramadd_err_hascollector();
-            return HOPE_PARAMADD_ERR_HASCOLLECTOR_CODE;
-        }
-        set->collector = (hope_param_t*) malloc(sizeof(hope_param_t));
-        if(!set->collector){
-            hope_err_alloc(HOPE_PARAMADD_ERR_GENERIC_MSG);
-            return HOPE_ERR_ALLOC_FAILED_CODE;
-        }
-        *set->collector = param;
-    } else {
-        // search for a parameter with the same name
-        for(size_t i = 0; i < set->nparams; i++){
-            hope_param_t *cur_param = set->params + i;
-            if(strcmp(cur_param->name, param.name) == 0){
-                hope_paramadd_err_duplicate(param.name);
-                return HOPE_PARAMADD_ERR_DUPLICATE_CODE;
-            }
-        }
-        set->params = (hope_param_t*) realloc(set->params, (set->nparams + 1) * sizeof(hope_param_t));
-        if(!set->params){
-            hope_err_alloc(HOPE_PARAMADD_ERR_GENERIC_MSG);
-            return HOPE_ERR_ALLOC_FAILED_CODE;
-        }
-        set->params[set->nparams] = param;
-        set->nparams++;
+// Resize an allocation of old_size bytes, it is left untouched if that fails
+void *hope_realloc(hope_alloc_t *alloc, void *ptr, size_t old_size, size_t size){
+    (void)old_size;
+    if(!ptr)
+        return hope_malloc(alloc, size);
+    void *grown = HOPE_REALLOC(alloc ? alloc->ctx : NULL, ptr, old_size, size);
+    #ifdef HOPE_ALLOC_STATS
+    if(grown && alloc){
+        alloc->calls++;
+        alloc->bytes = alloc->bytes - old_size + size;
+        if(alloc->bytes > alloc->peak)
+            alloc->peak = alloc->bytes;
     }
-    return HOPE_SUCCESS_CODE;
+    #endif
+    return grown;
 }
 
-// Initialize the hope data structure
-HOPEDEF hope_t hope_init(const char *prog_name, const char *prog_desc){
-    assert(prog_name && "prog_name cannot be NULL");
-    hope_t hope = {
-        .prog_name = prog_name,
-        .prog_desc = prog_desc,
-        .sets = NULL,
-        .results = NULL,
-        .nsets = 0,
-        .nresults = 0,
-        .used_set_name = NULL
-    };
-    return hope;
+// Release an allocation of size bytes
+void hope_dealloc(hope_alloc_t *alloc, void *ptr, size_t size){
+    (void)size;
+    if(!ptr)
+        return;
+    HOPE_FREE(alloc ? alloc->ctx : NULL, ptr, size);
+    #ifdef HOPE_ALLOC_STATS
+    if(alloc)
+        alloc->bytes -= size;
+    #endif
 }
-// Free the params in the hope data structure
-HOPEDEF void hope_free(hope_t *hope){
-    if (hope->sets){
-        for(size_t i = 0; i < hope->nsets; i++){
-            hope_set_t *set = (hope_set_t*)(hope->sets + i);
-            if(set->params) free(set->params);
-            if(set->collector) free(set->collector);
-            if (set->results){
-                for (size_t i = 0; i < set->nresults; i++){
-                    if(set->results[i].type != HOPE_TYPE_SWITCH)
-                        free(set->results[i].value.strings);
-                }
-                free(set->results);
-            }
-        }
-        free(hope->sets);
+#endif
+
+//
+// hope_arena_t functions
+//
+
+#define HOPE_ARENA_BLOCK_SIZE 4096
+#define HOPE_ARENA_ALIGN 16
+#define HOPE_ARENA_HEADER_SIZE ((sizeof(hope_arena_block_t) + HOPE_ARENA_ALIGN - 1) & ~(size_t)(HOPE_ARENA_ALIGN - 1))
+
+// Allocate memory from the arena, a new block is added if the current one is full
+void *hope_arena_alloc(hope_arena_t *arena, size_t size){
+    size = (size + HOPE_ARENA_ALIGN - 1) & ~(size_t)(HOPE_ARENA_ALIGN - 1);
+    hope_arena_block_t *block = arena->head;
+    if(!block || block->size - block->used < size){
+        #ifdef HOPE_NO_MALLOC
+        return NULL;
+        #else
+        // blocks grow with the arena, so the amount of blocks stays logarithmic
+        size_t block_size = block ? block->size * 2 : HOPE_ARENA_BLOCK_SIZE;
+        if(block_size < size)
+            block_size = size;
+        block = (hope_arena_block_t*) hope_malloc(arena->alloc, HOPE_ARENA_HEADER_SIZE + block_size);
+        if(!block)
+            return NULL;
+        block->next = arena->head;
+        block->size = block_size;
+        block->used = 0;
+        arena->head = block;
+        #endif
     }
-    hope->nsets = 0;
-    hope->nresults = 0;
+    void *ptr = (char*)block + HOPE_ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    return ptr;
 }
 
-// Generate and write the help message to the sink
-HOPEDEF void hope_print_help(hope_t *hope, FILE *sink){
-    const char *FMT_SWITCH_REQ = "%s ";
-    const char *FMT_SWITCH_OPT = "(%s) ";
-    const char *FMT_PARAM_REQ = "%s [%s] ";
-    const char *FMT_PARAM_OPT = "(%s [%s])? ";
-    const char *FMT_PARAM_OPTMORE = "(%s [%s]*) ";
-    const char *FMT_PARAM_MORE = "%s [%s]+ ";
-    const char *FMT_PARAM_REQ_SPECIFIC = "%s [%s]{%u} ";
-    
-    if(hope->prog_desc)
-        fprintf(sink, "%s\n", hope->prog_desc);
-    fprintf(sink, "Usage: %s ", hope->prog_name);
-
-    char *fmt_string = NULL;
-    for(size_t i = 0; i < hope->nsets; i++){
-        hope_set_t *set = (hope_set_t*)(hope->sets + i);
-        for(size_t j = 0; j < set->nparams; j++){
-            hope_param_t *cur_param = (hope_param_t*)(set->params + j);
-            if(cur_param->type == HOPE_TYPE_SWITCH){
-                fmt_string = (char*)(cur_param->nargs == HOPE_ARGC_OPT ? FMT_SWITCH_OPT : FMT_SWITCH_REQ);
-                printf(fmt_string, cur_param->name);
-            } else {
-                switch(cur_param->nargs){
-                    case HOPE_ARGC_MORE:
-                        fmt_string = (char*)FMT_PARAM_MORE;
-                        break;
-                    case HOPE_ARGC_OPTMORE:
-                        fmt_string = (char*)FMT_PARAM_OPTMORE;
-                        break;
-                    case HOPE_ARGC_OPT:
-                        fmt_string = (char*)FMT_PARAM_OPT;
-                        break;
-                    default:
-                        assert(cur_param->nargs > 0);
-                        fmt_string = (char*)(cur_param->nargs > 1 ? FMT_PARAM_REQ_SPECIFIC : FMT_PARAM_REQ);
-                        break;
-                }
-                if(cur_param-> nargs > 1)
-                    printf(fmt_string, cur_param->name, hope_argtype_str(cur_param->type), cur_param->nargs);  
-                else
-                    printf(fmt_string, cur_param->name, hope_argtype_str(cur_param->type));
-            }
-        }
-        if(i + 1 < hope->nsets) {
-            fprintf(sink, " | ");
-        }
-    }
-    fprintf(sink, "\n");
-    for(size_t i = 0; i < hope->nsets; i++){
-        hope_set_t *set = (hope_set_t*)(hope->sets + i);
-        fprintf(sink, "Parameter set %s:\n", set->name);
-        for(size_t j = 0; j < set->nparams; j++){
-            hope_param_t *cur_param = (hope_param_t *)(set->params + j);
-            if(cur_param->help)
-                fprintf(sink, "  %s: %s\n", cur_param->name, cur_param->help);
-        }
+// Release all blocks of the arena
+void hope_arena_free(hope_arena_t *arena){
+    // without malloc the block is the buffer of the caller
+    #ifndef HOPE_NO_MALLOC
+    hope_arena_block_t *block = arena->head;
+    while(block){
+        hope_arena_block_t *next = block->next;
+        hope_dealloc(arena->alloc, block, HOPE_ARENA_HEADER_SIZE + block->size);
+        block = next;
     }
+    #endif
+    arena->head = NULL;
 }
 
-HOPEDEF int hope_add_set(hope_t *hope, hope_set_t set) {
-    if(hope->sets){
-        for(size_t i = 0; i < hope->nsets; i++){
+// Hand out the memory of the arena again from the start, while keeping it allocated.
+// Several blocks are merged into a single one, so once the arena fits a parse no more blocks are added.
+void hope_arena_reset(hope_arena_t *arena){
+    hope_arena_block_t *block = arena->head;
+    if(!block)
+        return;
+    if(!block->next){
+        block->used = 0;
+        return;
+    }
+    #ifndef HOPE_NO_MALLOC
+    size_t size = 0;
+    for(; block; block = block->next)
+        size += block->size;
+    hope_arena_free(arena);
+    block = (hope_arena_block_t*) hope_malloc(arena->alloc, HOPE_ARENA_HEADER_SIZE + size);
+    // without a block the arena simply starts over
+    if(!block)
+        return;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    arena->head = block;
+    #endif
+}
+
+// Serve the arena from the given memory, the block header is placed at its start
+void hope_arena_use_buffer(hope_arena_t *arena, void *buf, size_t size){
+    arena->head = NULL;
+    // the start is aligned like everything the arena hands out
+    size_t skip = (HOPE_ARENA_ALIGN - (uintptr_t)buf % HOPE_ARENA_ALIGN) % HOPE_ARENA_ALIGN;
+    if(!buf || size < skip + HOPE_ARENA_HEADER_SIZE)
+        return;
+    hope_arena_block_t *block = (hope_arena_block_t*)((char*)buf + skip);
+    block->next = NULL;
+    block->size = size - skip - HOPE_ARENA_HEADER_SIZE;
+    block->used = 0;
+    arena->head = block;
+}
+
+//
+// Response files
+//
+
+// Response files may include each other up to this depth
+#define HOPE_RESPONSE_FILE_DEPTH 32
+
+/* Growing list of arguments, allocated from an arena
+ * Outgrown arrays stay in the arena, which keeps the copies logarithmic.
+ */
+typedef struct {
+    char **items;
+    size_t count;
+    size_t cap;
+} hope_arg_list_t;
+
+// Append an argument to the list
+int hope_arg_list_push(hope_arena_t *arena, hope_arg_list_t *list, char *arg){
+    if(list->count == list->cap){
+        size_t cap = list->cap ? list->cap * 2 : 64;
+        char **items = (char**) hope_arena_alloc(arena, cap * sizeof(char*));
+        if(!items)
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        if(list->count)
+            memcpy(items, list->items, list->count * sizeof(char*));
+        list->items = items;
+        list->cap = cap;
+    }
+    list->items[list->count++] = arg;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Release the response files, alloc is the allocator of the arena they were read with
+void hope_unmap_response_files(hope_alloc_t *alloc, hope_mapping_t **mappings){
+    (void)alloc;
+    for(hope_mapping_t *mapping = *mappings; mapping; mapping = mapping->next){
+        #ifdef HOPE_POSIX
+        if(mapping->data)
+            munmap(mapping->data, mapping->size);
+        #elif !defined(HOPE_NO_MALLOC)
+        hope_dealloc(alloc, mapping->data, mapping->cap);
+        #endif
+    }
+    *mappings = NULL;
+}
+
+/* Read the response file at path into the mapping and identify the file by id
+ * The file is mapped privately and writable, so it can be tokenized in place without ever changing the file.
+ * Without mmap the file is read into an allocation instead and only the nesting depth limits includes.
+ */
+int hope_map_response_file(hope_alloc_t *alloc, const char *path, hope_mapping_t *mapping, uint64_t id[2]){
+    (void)alloc;
+    *mapping = (hope_mapping_t){0};
+    id[0] = id[1] = 0;
+    #ifdef HOPE_POSIX
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){
+        close(fd);
+        return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    }
+    id[0] = (uint64_t)st.st_dev;
+    id[1] = (uint64_t)st.st_ino;
+    mapping->size = (size_t)st.st_size;
+    if(mapping->size > 0){
+        void *data = mmap(NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED){
+            close(fd);
+            return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+        }
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        mapping->data = (char*) data;
+        mapping->cap = (mapping->size + page - 1) / page * page;
+    }
+    close(fd);
+    #elif defined(HOPE_NO_MALLOC)
+    (void)path;
+    return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    #else
+    FILE *file = fopen(path, "rb");
+    if(!file)
+        return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    long size = -1;
+    if(fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    if(size < 0 || fseek(file, 0, SEEK_SET) != 0){
+        fclose(file);
+        return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    }
+    mapping->data = (char*) hope_malloc(alloc, (size_t)size + 1);
+    if(!mapping->data || fread(mapping->data, 1, (size_t)size, file) != (size_t)size){
+        hope_dealloc(alloc, mapping->data, (size_t)size + 1);
+        mapping->data = NULL;
+        fclose(file);
+        return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+    }
+    fclose(file);
+    mapping->size = (size_t)size;
+    mapping->cap = (size_t)size + 1;
+    #endif
+    return HOPE_SUCCESS_CODE;
+}
+
+/* Split a response file into arguments in place
+ * Arguments are separated by whitespace or NUL bytes. Single and double quotes group whitespace into an argument,
+ * outside of single quotes a backslash takes the next character literally.
+ * Quotes and escapes are removed by moving the rest of the argument forward, so every argument
+ * points into the mapping and is terminated in it. Only an argument that ends the last page of the file
+ * has no room for its terminator and is copied into the arena.
+ */
+int hope_tokenize_response_file(hope_arena_t *arena, hope_mapping_t *mapping, hope_arg_list_t *tokens){
+    char *data = mapping->data;
+    char *end = data + mapping->size;
+    char *read = data, *write = data;
+    for(;;){
+        while(read < end && (*read == '\0' || isspace((unsigned char)*read)))
+            read++;
+        if(read == end)
+            return HOPE_SUCCESS_CODE;
+        char *token = write;
+        char quote = '\0';
+        for(; read < end; read++){
+            char c = *read;
+            if(quote && c == quote){
+                quote = '\0';
+                continue;
+            }
+            if(!quote){
+                if(c == '\0' || isspace((unsigned char)c))
+                    break;
+                if(c == '\'' || c == '"'){
+                    quote = c;
+                    continue;
+                }
+            }
+            if(c == '\\' && quote != '\'' && read + 1 < end)
+                c = *++read;
+            *write++ = c;
+        }
+        if(quote)
+            return HOPE_PARSE_ERR_RESPONSE_FILE_CODE;
+        // the terminator goes where the separator was, or in the slack behind the end of the file
+        if((size_t)(write - data) < mapping->cap){
+            *write++ = '\0';
+        } else {
+            size_t len = (size_t)(write - token);
+            char *copy = (char*) hope_arena_alloc(arena, len + 1);
+            if(!copy)
+                return HOPE_ERR_ALLOC_FAILED_CODE;
+            memcpy(copy, token, len);
+            copy[len] = '\0';
+            token = copy;
+        }
+        // the terminator may have overwritten the separator, which is skipped all the same
+        if(read < end)
+            read++;
+        int code = hope_arg_list_push(arena, tokens, token);
+        if(code != HOPE_SUCCESS_CODE)
+            return code;
+    }
+}
+
+// Append the arguments to the list and expand the response files among them.
+// chain identifies the response files currently being expanded, depth is their amount.
+// A file that can not be read is stored in error, the position is the one of the @path argument at the top.
+int hope_expand_args(hope_arena_t *arena, hope_mapping_t **mappings, char **args, size_t nargs,
+                     hope_arg_list_t *list, uint64_t chain[][2], size_t depth, hope_error_t *error){
+    for(size_t i = 0; i < nargs; i++){
+        const char *path = args[i] + 1;
+        if(args[i][0] != '@' || *path == '\0'){
+            if(hope_arg_list_push(arena, list, args[i]) != HOPE_SUCCESS_CODE)
+                return HOPE_ERR_ALLOC_FAILED_CODE;
+            continue;
+        }
+        if(depth == 0)
+            error->arg = i;
+        if(depth == HOPE_RESPONSE_FILE_DEPTH){
+            error->value = path;
+            return HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE;
+        }
+        hope_mapping_t *mapping = (hope_mapping_t*) hope_arena_alloc(arena, sizeof(hope_mapping_t));
+        if(!mapping)
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        int code = hope_map_response_file(arena->alloc, path, mapping, chain[depth]);
+        if(code != HOPE_SUCCESS_CODE){
+            error->value = path;
+            return code;
+        }
+        mapping->next = *mappings;
+        *mappings = mapping;
+        #ifdef HOPE_POSIX
+        for(size_t j = 0; j < depth; j++){
+            if(chain[j][0] == chain[depth][0] && chain[j][1] == chain[depth][1]){
+                error->value = path;
+                return HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE;
+            }
+        }
+        #endif
+        hope_arg_list_t tokens = {0};
+        code = hope_tokenize_response_file(arena, mapping, &tokens);
+        if(code == HOPE_PARSE_ERR_RESPONSE_FILE_CODE)
+            error->value = path;
+        if(code == HOPE_SUCCESS_CODE)
+            code = hope_expand_args(arena, mappings, tokens.items, tokens.count, list, chain, depth + 1, error);
+        if(code != HOPE_SUCCESS_CODE)
+            return code;
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Replace every @path argument by the arguments in the response file at path.
+// The arguments are left as they are if none of them names a response file, a failure is described in error.
+int hope_expand_response_files(hope_arena_t *arena, hope_mapping_t **mappings, char *args[], char ***expanded, hope_error_t *error){
+    size_t nargs = 0;
+    bool any = false;
+    for(; args[nargs] != NULL; nargs++)
+        any |= args[nargs][0] == '@';
+    *expanded = args;
+    if(!any)
+        return HOPE_SUCCESS_CODE;
+    hope_arg_list_t list = {0};
+    uint64_t chain[HOPE_RESPONSE_FILE_DEPTH][2];
+    *error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+    int code = hope_expand_args(arena, mappings, args, nargs, &list, chain, 0, error);
+    if(code == HOPE_SUCCESS_CODE)
+        code = hope_arg_list_push(arena, &list, NULL);
+    error->code = code;
+    if(code == HOPE_SUCCESS_CODE)
+        *expanded = list.items;
+    return code;
+}
+
+//
+// hope_param_t functions
+//
+
+// Initialize the hope data structure
+HOPEDEF hope_param_t hope_init_param(const char *name, const char *help, enum hope_argtype_e type, int nargs){
+    hope_param_t param = {
+        .name = name,
+        .help = help,
+        .type = type,
+        .nargs = nargs,
+    };
+    return param;
+}
+
+HOPEDEF hope_param_t hope_param_default_integer(hope_param_t param, long int value){
+    param.has_default = true;
+    param.default_type = HOPE_TYPE_INTEGER;
+    param.default_value.integer = value;
+    return param;
+}
+
+HOPEDEF hope_param_t hope_param_default_double(hope_param_t param, double value){
+    param.has_default = true;
+    param.default_type = HOPE_TYPE_DOUBLE;
+    param.default_value._double = value;
+    return param;
+}
+
+HOPEDEF hope_param_t hope_param_default_string(hope_param_t param, const char *value){
+    param.has_default = true;
+    param.default_type = HOPE_TYPE_STRING;
+    param.default_value.string = value;
+    return param;
+}
+
+//
+// hope_set_t functions
+//
+
+HOPEDEF hope_set_t hope_init_set(const char *set_name){
+    return (hope_set_t) {
+        .name = set_name,
+        .nparams = 0,
+        .params = NULL,
+        .collector = NULL,
+        .results = NULL,
+        .nresults = 0,
+        .param_results = NULL,
+        .index = NULL,
+        .index_cap = 0
+    };
+}
+
+HOPEDEF hope_set_t hope_init_static_set(const char *set_name, const hope_param_t *params, size_t nparams){
+    hope_set_t set = hope_init_set(set_name);
+    // the array stays read-only, the set never writes through these pointers
+    bool collector = nparams > 0 && params[nparams - 1].name == NULL;
+    set.is_static = true;
+    set.params = (hope_param_t*) params;
+    set.nparams = collector ? nparams - 1 : nparams;
+    set.collector = collector ? (hope_param_t*)(params + nparams - 1) : NULL;
+    return set;
+}
+
+// Check the parameters of a static set like hope_add_param checks every parameter it adds, only their names are left
+// to be checked for duplicates once the set is compiled
+int hope_check_static_set(const hope_set_t *set, hope_error_t *error){
+    for(size_t i = 0; i <= set->nparams; i++){
+        const hope_param_t *param = i < set->nparams ? set->params + i : set->collector;
+        if(!param)
+            break;
+        int code = HOPE_SUCCESS_CODE;
+        if(i < set->nparams && param->name == NULL)
+            code = HOPE_PARAMADD_ERR_HASCOLLECTOR_CODE;
+        else if(!hope_argtype_valid(param->type))
+            code = HOPE_PARAMADD_ERR_TYPE_CODE;
+        else if(param->has_default && param->default_type != param->type)
+            code = HOPE_PARAMADD_ERR_DEFAULT_TYPE_CODE;
+        if(code != HOPE_SUCCESS_CODE){
+            *error = (hope_error_t){ .code = code, .arg = HOPE_ERROR_NO_ARG, .param = param->name ? param->name : "<collector>", .set = set->name };
+            return code;
+        }
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Hash at most limit characters of a name and measure how many were hashed in the same pass
+uint64_t hope_hash(const char *str, size_t limit, size_t *len){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const char *cur = str;
+    for(; *cur && (size_t)(cur - str) < limit; cur++){
+        hash ^= (unsigned char)*cur;
+        hash *= 0x100000001b3ULL;
+    }
+    *len = (size_t)(cur - str);
+    return hash;
+}
+
+// Check if a name starting with the character c can be in the bitmap
+bool hope_first_char_in(const uint64_t first_chars[4], char c){
+    unsigned char uc = (unsigned char)c;
+    return (first_chars[uc / 64] >> (uc % 64)) & 1;
+}
+
+// Find the index slot for the given name, returns the empty slot it would go into if it is missing
+hope_slot_t *hope_index_probe(const hope_set_t *set, const char *name, uint64_t hash, size_t len){
+    size_t mask = set->index_cap - 1;
+    for(size_t i = (size_t)hash & mask;; i = (i + 1) & mask){
+        hope_slot_t *slot = set->index + i;
+        if(slot->param == 0)
+            return slot;
+        if(slot->hash == hash && slot->len == len &&
+           memcmp(set->params[slot->param - 1].name, name, len) == 0)
+            return slot;
+    }
+}
+
+#ifdef HOPE_NO_MALLOC
+// Point the set at its own storage, which moves with the set when it is copied
+void hope_set_use_storage(hope_set_t *set){
+    set->params = set->param_storage;
+    set->collector = set->collector ? &set->collector_storage : NULL;
+    set->index = set->index_storage;
+    if(set->index_cap == 0){
+        // the index never grows, it takes the largest power of two that fits the storage
+        set->index_cap = 1;
+        while(set->index_cap * 2 <= sizeof(set->index_storage) / sizeof(hope_slot_t))
+            set->index_cap *= 2;
+    }
+}
+#endif
+
+#ifndef HOPE_NO_MALLOC
+/* Grow the index of the set so that it stays at most half full, then rehash all parameters into it
+ * The parameters grow along with it, they always have room for index_cap / 2 of them.
+ */
+int hope_index_grow(hope_set_t *set){
+    size_t new_cap = set->index_cap ? set->index_cap * 2 : 16;
+    hope_slot_t *old_index = set->index;
+    size_t old_cap = set->index_cap;
+    set->index = (hope_slot_t*) hope_malloc(set->alloc, new_cap * sizeof(hope_slot_t));
+    if(!set->index){
+        set->index = old_index;
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    hope_param_t *params = (hope_param_t*) hope_realloc(set->alloc, set->params,
+        old_cap / 2 * sizeof(hope_param_t), new_cap / 2 * sizeof(hope_param_t));
+    if(!params){
+        hope_dealloc(set->alloc, set->index, new_cap * sizeof(hope_slot_t));
+        set->index = old_index;
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    set->params = params;
+    memset(set->index, 0, new_cap * sizeof(hope_slot_t));
+    set->index_cap = new_cap;
+    for(size_t i = 0; i < old_cap; i++){
+        if(old_index[i].param == 0)
+            continue;
+        // names in the old index are unique, so only look for the next free slot
+        size_t j = (size_t)old_index[i].hash & (new_cap - 1);
+        while(set->index[j].param != 0)
+            j = (j + 1) & (new_cap - 1);
+        set->index[j] = old_index[i];
+    }
+    hope_dealloc(set->alloc, old_index, old_cap * sizeof(hope_slot_t));
+    return HOPE_SUCCESS_CODE;
+}
+
+// Bytes the parameters, collector and index of the set take
+size_t hope_set_bytes(const hope_set_t *set){
+    return set->index_cap / 2 * sizeof(hope_param_t) + (set->collector ? sizeof(hope_param_t) : 0) +
+           set->index_cap * sizeof(hope_slot_t);
+}
+
+// Free the parameters, collector and index of the set
+void hope_set_free_memory(hope_alloc_t *alloc, hope_set_t *set){
+    hope_dealloc(alloc, set->params, set->index_cap / 2 * sizeof(hope_param_t));
+    hope_dealloc(alloc, set->collector, sizeof(hope_param_t));
+    hope_dealloc(alloc, set->index, set->index_cap * sizeof(hope_slot_t));
+}
+
+// Copy the parameters, collector and index of the set to memory of the allocator, the old memory is not freed
+int hope_set_copy_memory(hope_alloc_t *alloc, hope_set_t *set){
+    hope_set_t copy = *set;
+    size_t params_size = set->index_cap / 2 * sizeof(hope_param_t), index_size = set->index_cap * sizeof(hope_slot_t);
+    copy.params = params_size ? (hope_param_t*) hope_malloc(alloc, params_size) : NULL;
+    copy.index = index_size ? (hope_slot_t*) hope_malloc(alloc, index_size) : NULL;
+    copy.collector = set->collector ? (hope_param_t*) hope_malloc(alloc, sizeof(hope_param_t)) : NULL;
+    if((params_size && !copy.params) || (index_size && !copy.index) || (set->collector && !copy.collector)){
+        hope_dealloc(alloc, copy.params, params_size);
+        hope_dealloc(alloc, copy.index, index_size);
+        hope_dealloc(alloc, copy.collector, sizeof(hope_param_t));
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    if(params_size)
+        memcpy(copy.params, set->params, params_size);
+    if(index_size)
+        memcpy(copy.index, set->index, index_size);
+    if(set->collector)
+        *copy.collector = *set->collector;
+    *set = copy;
+    return HOPE_SUCCESS_CODE;
+}
+#endif
+
+// Add a new parameter to the set
+HOPEDEF int hope_add_param(hope_set_t *set, hope_param_t param){
+    return hope_add_param_handle(set, param, NULL);
+}
+
+// Add a new parameter to the set and store a handle for it
+HOPEDEF int hope_add_param_handle(hope_set_t *set, hope_param_t param, hope_handle_t *handle){
+    if(set->is_static){
+        hope_eprintf(HOPE_FMT_DEFAULT "\n", HOPE_PARAMADD_ERR_GENERIC_MSG, HOPE_ERR_INVALID_STRUCT_MSG);
+        return HOPE_ERR_INVALID_STRUCT_CODE;
+    }
+    #ifdef HOPE_NO_MALLOC
+    hope_set_use_storage(set);
+    #endif
+    if(!hope_argtype_valid(param.type)){
+        hope_paramadd_err_type(param.name);
+        return HOPE_PARAMADD_ERR_TYPE_CODE;
+    }
+    if(param.has_default && param.default_type != param.type){
+        hope_paramadd_err_default_type(param.name);
+        return HOPE_PARAMADD_ERR_DEFAULT_TYPE_CODE;
+    }
+    if(param.name == NULL){
+        if(set->collector != NULL){
+            hope_paramadd_err_hascollector();
+            return HOPE_PARAMADD_ERR_HASCOLLECTOR_CODE;
+        }
+        #ifdef HOPE_NO_MALLOC
+        set->collector = &set->collector_storage;
+        #else
+        set->collector = (hope_param_t*) hope_malloc(set->alloc, sizeof(hope_param_t));
+        #endif
+        if(!set->collector){
+            hope_err_alloc(HOPE_PARAMADD_ERR_GENERIC_MSG);
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        }
+        *set->collector = param;
+        if(handle)
+            *handle = (hope_handle_t){ .set = set->name, .index = HOPE_HANDLE_COLLECTOR };
+    } else {
+        #ifdef HOPE_NO_MALLOC
+        if(set->nparams == HOPE_MAX_PARAMS){
+            hope_err_alloc(HOPE_PARAMADD_ERR_GENERIC_MSG);
+            return HOPE_ERR_CAPACITY_CODE;
+        }
+        #else
+        if((set->nparams + 1) * 2 > set->index_cap && hope_index_grow(set) != HOPE_SUCCESS_CODE){
+            hope_err_alloc(HOPE_PARAMADD_ERR_GENERIC_MSG);
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        }
+        #endif
+        // search for a parameter with the same name
+        size_t len;
+        uint64_t hash = hope_hash(param.name, SIZE_MAX, &len);
+        hope_slot_t *slot = hope_index_probe(set, param.name, hash, len);
+        if(slot->param != 0){
+            hope_paramadd_err_duplicate(param.name);
+            return HOPE_PARAMADD_ERR_DUPLICATE_CODE;
+        }
+        set->params[set->nparams] = param;
+        set->nparams++;
+        *slot = (hope_slot_t){
+            .hash = hash,
+            .len = len,
+            .param = set->nparams
+        };
+        if(handle)
+            *handle = (hope_handle_t){ .set = set->name, .index = set->nparams - 1 };
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Initialize the hope data structure
+HOPEDEF hope_t hope_init(const char *prog_name, const char *prog_desc){
+    assert(prog_name && "prog_name cannot be NULL");
+    hope_t hope = {
+        .prog_name = prog_name,
+        .prog_desc = prog_desc,
+        .sets = NULL,
+        .results = NULL,
+        .nsets = 0,
+        .nresults = 0,
+        .param_results = NULL,
+        .used_set = 0,
+        .used_set_name = NULL,
+        .arena = {0},
+        .table = NULL,
+        .flags = 0,
+        .mappings = NULL,
+        .alloc = {0},
+        .help = NULL,
+        .help_len = 0,
+        .help_width = 0
+    };
+    return hope;
+}
+// Free the params in the hope data structure
+HOPEDEF void hope_free(hope_t *hope){
+    #ifndef HOPE_NO_MALLOC
+    if (hope->sets){
+        for(size_t i = 0; i < hope->nsets; i++){
+            hope_set_t *set = (hope_set_t*)(hope->sets + i);
+            if(!set->is_static)
+                hope_set_free_memory(set->alloc ? set->alloc : &hope->alloc, set);
+        }
+        hope_dealloc(&hope->alloc, hope->sets, hope->nsets * sizeof(hope_set_t));
+    }
+    #endif
+    // the results of all sets live in the arena, their strings may point into response files
+    hope->arena.alloc = &hope->alloc;
+    hope_unmap_response_files(&hope->alloc, &hope->mappings);
+    hope_arena_free(&hope->arena);
+    #ifndef HOPE_NO_MALLOC
+    if(hope->table)
+        hope_dealloc(&hope->alloc, hope->table, hope->table->size);
+    hope_dealloc(&hope->alloc, hope->help, hope->help_len);
+    #endif
+    hope->table = NULL;
+    hope->help = NULL;
+    hope->nsets = 0;
+    hope->results = NULL;
+    hope->nresults = 0;
+    hope->param_results = NULL;
+}
+
+HOPEDEF void hope_reset(hope_t *hope){
+    // results of hope_parse_set live in the arena as well
+    for(size_t i = 0; i < hope->nsets; i++){
+        hope->sets[i].results = NULL;
+        hope->sets[i].nresults = 0;
+        hope->sets[i].param_results = NULL;
+    }
+    hope->arena.alloc = &hope->alloc;
+    hope_unmap_response_files(&hope->alloc, &hope->mappings);
+    hope_arena_reset(&hope->arena);
+    hope->results = NULL;
+    hope->nresults = 0;
+    hope->param_results = NULL;
+    hope->used_set = 0;
+    hope->used_set_name = NULL;
+    // the error of the previous parse or getter must not outlive its results
+    hope->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+}
+
+#ifdef HOPE_NO_MALLOC
+HOPEDEF void hope_set_buffer(hope_t *hope, void *buf, size_t size){
+    hope->buffer = buf;
+    hope->buffer_size = size;
+    // the table is placed in the buffer by the next compile
+    hope->table = NULL;
+    hope->arena.head = NULL;
+    hope->results = NULL;
+    hope->nresults = 0;
+    hope->param_results = NULL;
+}
+#endif
+
+//
+// Help message
+//
+
+/* Text the help message is rendered into
+ * data: the text rendered so far (NULL to only measure the text)
+ * len: the length of the text in data, or of the whole text when measuring
+ * cap: the size of data
+ * sink: where data is written to whenever it is full (NULL if the whole text has to fit into data)
+ * col: the column the text ends at, for wrapping
+ */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    FILE *sink;
+    size_t col;
+} hope_writer_t;
+
+// Default width of the help message if the sink is no terminal and COLUMNS is not set
+#define HOPE_HELP_WIDTH 80
+
+// Append len bytes of str to the text
+void hope_write(hope_writer_t *out, const char *str, size_t len){
+    for(size_t i = 0; i < len; i++)
+        out->col = str[i] == '\n' ? 0 : out->col + 1;
+    if(out->sink && out->len + len > out->cap){
+        fwrite(out->data, 1, out->len, out->sink);
+        out->len = 0;
+        if(len > out->cap){
+            fwrite(str, 1, len, out->sink);
+            return;
+        }
+    }
+    if(out->data && out->len + len <= out->cap)
+        memcpy(out->data + out->len, str, len);
+    out->len += len;
+}
+
+void hope_write_str(hope_writer_t *out, const char *str){
+    hope_write(out, str, strlen(str));
+}
+
+// Pad the current line with spaces up to the column
+void hope_write_pad(hope_writer_t *out, size_t col){
+    static const char spaces[] = "                                ";
+    while(out->col < col){
+        size_t n = col - out->col < sizeof(spaces) - 1 ? col - out->col : sizeof(spaces) - 1;
+        hope_write(out, spaces, n);
+    }
+}
+
+// Write the text word by word, a word that would cross the width starts a new line at the indent
+void hope_write_wrapped(hope_writer_t *out, const char *text, size_t indent, size_t width){
+    for(const char *cur = text; *cur;){
+        if(*cur == ' ' || *cur == '\n'){
+            cur++;
+            continue;
+        }
+        size_t len = strcspn(cur, " \n");
+        if(out->col > indent && out->col + 1 + len > width){
+            hope_write(out, "\n", 1);
+            hope_write_pad(out, indent);
+        } else if(out->col > indent){
+            hope_write(out, " ", 1);
+        }
+        hope_write_pad(out, indent);
+        hope_write(out, cur, len);
+        cur += len;
+    }
+}
+
+/* Split the usage of a parameter into parts, e.g. "(-i [integer])?" into "(", "-i", " [", "integer", "])?"
+ * num receives the argument count of parameters taking a fixed amount. Returns the amount of parts.
+ */
+size_t hope_usage_parts(const hope_param_t *param, const char *parts[6], char num[24]){
+    bool optional = param->nargs == HOPE_ARGC_OPT || param->nargs == HOPE_ARGC_OPTMORE;
+    size_t n = 0;
+    if(param->type == HOPE_TYPE_SWITCH){
+        optional = param->nargs == HOPE_ARGC_OPT;
+        if(optional)
+            parts[n++] = "(";
+        parts[n++] = param->name;
+        if(optional)
+            parts[n++] = ")";
+        return n;
+    }
+    if(optional)
+        parts[n++] = "(";
+    parts[n++] = param->name;
+    parts[n++] = " [";
+    parts[n++] = hope_argtype_str(param->type);
+    switch(param->nargs){
+        case HOPE_ARGC_MORE:
+            parts[n++] = "]+";
+            break;
+        case HOPE_ARGC_OPTMORE:
+            parts[n++] = "]*)";
+            break;
+        case HOPE_ARGC_OPT:
+            parts[n++] = "])?";
+            break;
+        default:
+            assert(param->nargs > 0);
+            if(param->nargs > 1){
+                snprintf(num, 24, "]{%d}", param->nargs);
+                parts[n++] = num;
+            } else {
+                parts[n++] = "]";
+            }
+            break;
+    }
+    return n;
+}
+
+/* Render the help message for a terminal of the given width
+ * The usage lists every set, wrapped below the program name. The parameters of all sets share one column
+ * for their help texts, which wrap within it. Names too long for the column put their help on the next line.
+ */
+void hope_render_help(const hope_t *hope, size_t width, hope_writer_t *out){
+    if(hope->prog_desc){
+        hope_write_wrapped(out, hope->prog_desc, 0, width);
+        hope_write(out, "\n", 1);
+    }
+    hope_write_str(out, "Usage: ");
+    hope_write_str(out, hope->prog_name);
+    size_t indent = out->col + 1;
+    // past half of the line the usage is indented like a paragraph instead
+    if(indent > width / 2)
+        indent = 4;
+    size_t name_len = 0;
+    for(size_t i = 0; i < hope->nsets; i++){
+        const hope_set_t *set = hope->sets + i;
+        for(size_t j = 0; j < set->nparams; j++){
+            const hope_param_t *param = set->params + j;
+            const char *parts[6];
+            char num[24];
+            size_t nparts = hope_usage_parts(param, parts, num);
+            size_t len = 0;
+            for(size_t k = 0; k < nparts; k++)
+                len += strlen(parts[k]);
+            if(out->col + 1 + len > width && out->col > indent){
+                hope_write(out, "\n", 1);
+                hope_write_pad(out, indent);
+            } else {
+                hope_write(out, " ", 1);
+            }
+            for(size_t k = 0; k < nparts; k++)
+                hope_write_str(out, parts[k]);
+            if(param->help && strlen(param->name) > name_len)
+                name_len = strlen(param->name);
+        }
+        if(i + 1 < hope->nsets)
+            hope_write(out, " |", 2);
+    }
+    hope_write(out, "\n", 1);
+    size_t help_col = 2 + name_len + 2;
+    if(help_col > width / 2)
+        help_col = width / 2;
+    for(size_t i = 0; i < hope->nsets; i++){
+        const hope_set_t *set = hope->sets + i;
+        hope_write_str(out, "Parameter set ");
+        hope_write_str(out, set->name);
+        hope_write(out, ":\n", 2);
+        for(size_t j = 0; j < set->nparams; j++){
+            const hope_param_t *param = set->params + j;
+            if(!param->help)
+                continue;
+            hope_write(out, "  ", 2);
+            hope_write_str(out, param->name);
+            if(out->col + 2 > help_col)
+                hope_write(out, "\n", 1);
+            hope_write_pad(out, help_col);
+            hope_write_wrapped(out, param->help, help_col, width);
+            hope_write(out, "\n", 1);
+        }
+    }
+}
+
+// Get the width of the terminal the sink writes to, COLUMNS or HOPE_HELP_WIDTH if it is none
+size_t hope_terminal_width(FILE *sink){
+    #ifdef HOPE_POSIX
+    int fd = sink == stdout ? STDOUT_FILENO : (sink == stderr ? STDERR_FILENO : -1);
+    struct winsize ws;
+    if(fd >= 0 && isatty(fd) && ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+        return ws.ws_col;
+    #else
+    (void)sink;
+    #endif
+    const char *columns = getenv("COLUMNS");
+    long value = columns ? strtol(columns, NULL, 10) : 0;
+    return value > 0 ? (size_t)value : HOPE_HELP_WIDTH;
+}
+
+// Render the help message and write it to the sink, a buffer on the stack at a time
+void hope_print_help_chunked(const hope_t *hope, size_t width, FILE *sink){
+    char buf[4096];
+    hope_writer_t out = { .data = buf, .cap = sizeof(buf), .sink = sink };
+    hope_render_help(hope, width, &out);
+    fwrite(buf, 1, out.len, sink);
+}
+
+// Write the help message to the sink. It is rendered once into a buffer of its exact size,
+// which is kept until the sets change, so printing it again is a single write.
+HOPEDEF void hope_print_help(hope_t *hope, FILE *sink){
+    size_t width = hope_terminal_width(sink);
+    #ifdef HOPE_NO_MALLOC
+    // without malloc nothing can be kept, so the help is rendered every time
+    hope_print_help_chunked(hope, width, sink);
+    #else
+    if(!hope->help || hope->help_width != width){
+        // the first pass only measures the text
+        hope_writer_t out = {0};
+        hope_render_help(hope, width, &out);
+        char *help = (char*) hope_malloc(&hope->alloc, out.len);
+        if(!help){
+            hope_print_help_chunked(hope, width, sink);
+            return;
+        }
+        hope_dealloc(&hope->alloc, hope->help, hope->help_len);
+        out = (hope_writer_t){ .data = help, .cap = out.len };
+        hope_render_help(hope, width, &out);
+        hope->help = help;
+        hope->help_len = out.len;
+        hope->help_width = width;
+    }
+    fwrite(hope->help, 1, hope->help_len, sink);
+    #endif
+}
+
+HOPEDEF int hope_add_set(hope_t *hope, hope_set_t set) {
+    // the size and help of a set rely on its parameters, so a static set is checked before it is taken
+    hope_error_t error;
+    if(set.is_static && hope_check_static_set(&set, &error) != HOPE_SUCCESS_CODE){
+        hope->error = error;
+        if(!(hope->flags & HOPE_FLAG_QUIET))
+            hope_paramadd_err_any(error.code, error.param);
+        return error.code;
+    }
+    if(hope->sets){
+        for(size_t i = 0; i < hope->nsets; i++){
             if(!strcmp(hope->sets[i].name, set.name)){
-                hope_setadd_err_duplicate(set.name);
+                hope->error = (hope_error_t){ .code = HOPE_SETADD_ERR_DUPLICATE_CODE, .arg = HOPE_ERROR_NO_ARG, .set = set.name };
+                if(!(hope->flags & HOPE_FLAG_QUIET))
+                    hope_setadd_err_duplicate(set.name);
                 return HOPE_SETADD_ERR_DUPLICATE_CODE;
             }
         }
     }
-    hope->sets = (hope_set_t*) realloc(hope->sets, (hope->nsets + 1) * sizeof(hope_set_t));
-    if(!hope->sets) {
-        hope_err_alloc(HOPE_SETADD_ERR_GENERIC_MSG);
+    #ifdef HOPE_NO_MALLOC
+    if(hope->nsets == HOPE_MAX_SETS){
+        hope->error = (hope_error_t){ .code = HOPE_ERR_CAPACITY_CODE, .arg = HOPE_ERROR_NO_ARG, .set = set.name };
+        if(!(hope->flags & HOPE_FLAG_QUIET))
+            hope_err_alloc(HOPE_SETADD_ERR_GENERIC_MSG);
+        return HOPE_ERR_CAPACITY_CODE;
+    }
+    hope->sets = hope->set_storage;
+    hope->sets[hope->nsets] = set;
+    if(!set.is_static)
+        hope_set_use_storage(hope->sets + hope->nsets);
+    #else
+    // the parser takes over the memory of a set built without an allocator and frees it through its own, which gets
+    // a copy of it unless it hands out the same memory as malloc
+    hope_set_t adopted = set;
+    bool adopt = !set.is_static && !set.alloc, copy = adopt && hope->alloc.ctx;
+    hope_set_t *sets = NULL;
+    if(!copy || hope_set_copy_memory(&hope->alloc, &adopted) == HOPE_SUCCESS_CODE){
+        sets = (hope_set_t*) hope_realloc(&hope->alloc, hope->sets,
+            hope->nsets * sizeof(hope_set_t), (hope->nsets + 1) * sizeof(hope_set_t));
+        if(!sets && copy)
+            hope_set_free_memory(&hope->alloc, &adopted);
+    }
+    if(!sets) {
+        hope->error = (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG, .set = set.name };
+        if(!(hope->flags & HOPE_FLAG_QUIET))
+            hope_err_alloc(HOPE_SETADD_ERR_GENERIC_MSG);
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    if(copy){
+        hope_set_free_memory(NULL, &set);
+    }
+    #ifdef HOPE_ALLOC_STATS
+    else if(adopt){
+        hope->alloc.bytes += hope_set_bytes(&set);
+        if(hope->alloc.bytes > hope->alloc.peak)
+            hope->alloc.peak = hope->alloc.bytes;
+    }
+    #endif
+    hope->sets = sets;
+    hope->sets[hope->nsets] = adopted;
+    if(hope->table)
+        hope_dealloc(&hope->alloc, hope->table, hope->table->size);
+    hope_dealloc(&hope->alloc, hope->help, hope->help_len);
+    #endif
+    hope->nsets++;
+    // the table and the help no longer match the sets
+    hope->table = NULL;
+    hope->help = NULL;
+    return HOPE_SUCCESS_CODE;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HOPE_SWAR 1
+#endif
+
+#ifdef HOPE_SWAR
+// Load 8 characters into a word, the first one in the lowest byte
+uint64_t hope_swar_load8(const char *str){
+    uint64_t word;
+    memcpy(&word, str, sizeof(word));
+    return word;
+}
+
+// Check if all 8 characters in the word are decimal digits
+bool hope_swar_is_digits8(uint64_t word){
+    // a byte below '0' borrows in the subtraction, a byte above '9' carries into its top bit in the addition
+    return (((word + 0x4646464646464646ULL) | (word - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0;
+}
+
+// Convert 8 decimal digits to their value by combining neighbouring digits, then pairs and quads
+uint32_t hope_swar_digits8(uint64_t word){
+    word -= 0x3030303030303030ULL;
+    word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFULL;
+    word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFULL;
+    word = (word * 10000 + (word >> 32)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t)word;
+}
+#endif
+
+// Get the value of a digit in the given base, or -1 if the character is not one
+int hope_digit_value(char c, unsigned base){
+    int value;
+    if(c >= '0' && c <= '9')
+        value = c - '0';
+    else if(c >= 'a' && c <= 'f')
+        value = c - 'a' + 10;
+    else if(c >= 'A' && c <= 'F')
+        value = c - 'A' + 10;
+    else
+        return -1;
+    return value < (int)base ? value : -1;
+}
+
+/* Parse a whole argument as an integer, independent of the locale
+ * An optional sign may be followed by a 0x, 0o or 0b prefix for hexadecimal, octal and binary,
+ * without one the number is decimal, even if it starts with 0.
+ * Single underscores may separate digits. Anything else in the argument makes it unparsable,
+ * values that do not fit a long int are out of range.
+ */
+int hope_parse_long(const char *str, long int *value){
+    const char *cur = str;
+    bool negative = false;
+    if(*cur == '+' || *cur == '-')
+        negative = *cur++ == '-';
+    unsigned base = 10;
+    if(cur[0] == '0' && cur[1] != '\0'){
+        switch(cur[1]){
+            case 'x': case 'X': base = 16; break;
+            case 'o': case 'O': base = 8; break;
+            case 'b': case 'B': base = 2; break;
+        }
+        if(base != 10)
+            cur += 2;
+    }
+    unsigned long long limit = negative ? (unsigned long long)LONG_MAX + 1 : (unsigned long long)LONG_MAX;
+    unsigned long long acc = 0;
+    #ifdef HOPE_SWAR
+    const char *end = cur + strlen(cur);
+    #endif
+    size_t ndigits = 0;
+    bool separated = false;
+    for(;;){
+        #ifdef HOPE_SWAR
+        // runs of 8 decimal digits are converted at once
+        if(base == 10 && end - cur >= 8){
+            uint64_t word = hope_swar_load8(cur);
+            if(hope_swar_is_digits8(word)){
+                unsigned long long chunk = hope_swar_digits8(word);
+                if(acc > (limit - chunk) / 100000000ULL)
+                    return HOPE_PARSE_ERR_PARAM_RANGE_CODE;
+                acc = acc * 100000000ULL + chunk;
+                ndigits += 8;
+                separated = false;
+                cur += 8;
+                continue;
+            }
+        }
+        #endif
+        if(*cur == '_'){
+            // a separator has to sit between two digits
+            if(ndigits == 0 || separated)
+                return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+            separated = true;
+            cur++;
+            continue;
+        }
+        int digit = hope_digit_value(*cur, base);
+        if(digit < 0)
+            break;
+        if(acc > (limit - (unsigned)digit) / base)
+            return HOPE_PARSE_ERR_PARAM_RANGE_CODE;
+        acc = acc * base + (unsigned)digit;
+        ndigits++;
+        separated = false;
+        cur++;
+    }
+    if(*cur != '\0' || ndigits == 0 || separated)
+        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+    // the magnitude of LONG_MIN does not fit a long int, so it is negated one below it
+    if(negative && acc > 0)
+        *value = -(long int)(acc - 1) - 1;
+    else
+        *value = (long int)acc;
+    return HOPE_SUCCESS_CODE;
+}
+
+// parse an integer and store it in the next free slot of the result
+int hope_parse_integer_into_result(const char *str, hope_result_t *result){
+    long int next_val;
+    int parse_code = hope_parse_long(str, &next_val);
+    if(parse_code != HOPE_SUCCESS_CODE)
+        return parse_code;
+    result->value.integers[result->count] = next_val;
+    result->count++;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Check if the argument is the given lowercase word, ignoring case
+bool hope_is_word(const char *str, const char *word){
+    for(; *word; str++, word++){
+        if((*str | 0x20) != *word)
+            return false;
+    }
+    return *str == '\0';
+}
+
+// Convert an argument that already passed validation with strtod, rewritten as its significant digits and an exponent.
+// Without a decimal point the number means the same in every locale. Only the first 768 significant digits are kept,
+// enough to decide the rounding of any double, and a dropped nonzero digit is kept as a trailing 1 so a value just
+// above a tie still rounds up. The copy is bounded by that, whatever the length of the argument.
+int hope_parse_double_digits(const char *str, double *value){
+    enum { max_digits = 768 };
+    // sign, the digits, a sticky digit, "e", the sign and digits of the exponent and the terminator
+    char buf[1 + max_digits + 1 + 2 + 20 + 1];
+    char *dst = buf;
+    const char *cur = str;
+    if(*cur == '+' || *cur == '-')
+        *dst++ = *cur++;
+    long exponent = 0;
+    int ndigits = 0;
+    bool sticky = false, fraction = false;
+    for(; *cur && *cur != 'e' && *cur != 'E'; cur++){
+        if(*cur == '.'){
+            fraction = true;
+        } else if(ndigits == 0 && *cur == '0'){
+            exponent -= fraction;
+        } else if(ndigits < max_digits){
+            *dst++ = *cur;
+            ndigits++;
+            exponent -= fraction;
+        } else {
+            sticky |= *cur != '0';
+            exponent += !fraction;
+        }
+    }
+    if(ndigits == 0)
+        *dst++ = '0';
+    if(sticky){
+        *dst++ = '1';
+        exponent--;
+    }
+    if(*cur){
+        // the exponent was validated, anything this large is zero or infinite anyway
+        bool negative_exponent = *++cur == '-';
+        cur += *cur == '+' || *cur == '-';
+        long explicit_exponent = 0;
+        for(; *cur; cur++){
+            if(explicit_exponent < 100000)
+                explicit_exponent = explicit_exponent * 10 + (*cur - '0');
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+    *dst++ = 'e';
+    if(exponent < 0)
+        *dst++ = '-';
+    unsigned long magnitude = exponent < 0 ? 0UL - (unsigned long)exponent : (unsigned long)exponent;
+    char reversed[20];
+    int nreversed = 0;
+    do {
+        reversed[nreversed++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude);
+    while(nreversed)
+        *dst++ = reversed[--nreversed];
+    *dst = '\0';
+    *value = strtod(buf, NULL);
+    return HOPE_SUCCESS_CODE;
+}
+
+// Convert an argument that already passed validation with strtod, which needs the decimal point of the locale.
+// In the "C" locale the argument is handed over as it is, otherwise it is rewritten without the decimal point first.
+int hope_parse_double_slow(const char *str, double *value){
+    const char *point = localeconv()->decimal_point;
+    if(point[0] == '.' && point[1] == '\0'){
+        *value = strtod(str, NULL);
+        return HOPE_SUCCESS_CODE;
+    }
+    return hope_parse_double_digits(str, value);
+}
+
+/* Parse a whole argument as a double, independent of the locale
+ * Accepted are decimal numbers with an optional sign, fraction and exponent, as well as inf, infinity and nan.
+ * Anything else in the argument makes it unparsable.
+ * Clinger's fast path covers numbers whose digits fit a double exactly and whose power of ten is exact as well,
+ * a single correctly rounded multiplication or division then gives the correctly rounded result.
+ * All other numbers are handed to strtod, they cost the validation and a lookup of the decimal point on top of it,
+ * about a fifth more than strtod alone for a full-precision value like those printed with %.17g.
+ */
+int hope_parse_double(const char *str, double *value){
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char *cur = str;
+    bool negative = false;
+    if(*cur == '+' || *cur == '-')
+        negative = *cur++ == '-';
+    if(hope_is_word(cur, "inf") || hope_is_word(cur, "infinity")){
+        *value = negative ? -HUGE_VAL : HUGE_VAL;
+        return HOPE_SUCCESS_CODE;
+    }
+    if(hope_is_word(cur, "nan")){
+        *value = negative ? -NAN : NAN;
+        return HOPE_SUCCESS_CODE;
+    }
+    // up to 19 significant digits are kept, the rest only decides if the mantissa is exact
+    uint64_t mantissa = 0;
+    int nsignificant = 0;
+    long exponent = 0;
+    bool exact = true, digits = false;
+    for(; *cur >= '0' && *cur <= '9'; cur++){
+        digits = true;
+        if(nsignificant < 19){
+            mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+            nsignificant += mantissa != 0;
+        } else {
+            exponent++;
+            exact &= *cur == '0';
+        }
+    }
+    if(*cur == '.'){
+        for(cur++; *cur >= '0' && *cur <= '9'; cur++){
+            digits = true;
+            if(nsignificant < 19){
+                mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+                nsignificant += mantissa != 0;
+                exponent--;
+            } else {
+                exact &= *cur == '0';
+            }
+        }
+    }
+    if(!digits)
+        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+    if(*cur == 'e' || *cur == 'E'){
+        cur++;
+        bool negative_exponent = false;
+        if(*cur == '+' || *cur == '-')
+            negative_exponent = *cur++ == '-';
+        if(*cur < '0' || *cur > '9')
+            return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+        long explicit_exponent = 0;
+        for(; *cur >= '0' && *cur <= '9'; cur++){
+            // anything this large is zero or infinite anyway
+            if(explicit_exponent < 100000)
+                explicit_exponent = explicit_exponent * 10 + (*cur - '0');
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+    if(*cur != '\0')
+        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+    #if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if(exact && mantissa <= ((uint64_t)1 << 53)){
+        if(mantissa == 0){
+            *value = negative ? -0.0 : 0.0;
+            return HOPE_SUCCESS_CODE;
+        }
+        // a small mantissa can take part of a larger power of ten and stay exact
+        while(exponent > 22 && mantissa <= ((uint64_t)1 << 53) / 10){
+            mantissa *= 10;
+            exponent--;
+        }
+        if(exponent >= -22 && exponent <= 22){
+            double result = (double)mantissa;
+            if(exponent < 0)
+                result /= powers[-exponent];
+            else
+                result *= powers[exponent];
+            *value = negative ? -result : result;
+            return HOPE_SUCCESS_CODE;
+        }
+    }
+    #else
+    (void)powers;
+    #endif
+    return hope_parse_double_slow(str, value);
+}
+
+// parse a double and store it in the next free slot of the result
+int hope_parse_double_into_result(const char *str, hope_result_t *result){
+    double next_val;
+    int parse_code = hope_parse_double(str, &next_val);
+    if(parse_code != HOPE_SUCCESS_CODE)
+        return parse_code;
+    result->value.doubles[result->count] = next_val;
+    result->count++;
+    return HOPE_SUCCESS_CODE;
+}
+
+// store the string in the next free slot of the result
+int hope_parse_string_into_result(const char *str, hope_result_t *result){
+    result->value.strings[result->count] = str;
+    result->count++;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Convert the values a lazy parse stored as strings, they are kept as strings if one of them is invalid
+// and the reason is reported into error like a failed parse
+int hope_convert_result(hope_result_t *result, unsigned flags, hope_error_t *error){
+    if(!result->raw)
+        return HOPE_SUCCESS_CODE;
+    for(size_t i = 0; i < result->count; i++){
+        int parse_code = result->type == HOPE_TYPE_INTEGER ?
+            hope_parse_long(result->raw[i], result->value.integers + i) :
+            hope_parse_double(result->raw[i], result->value.doubles + i);
+        if(parse_code != HOPE_SUCCESS_CODE){
+            hope_report_error(flags, error, (hope_error_t){
+                .code = parse_code,
+                .arg = HOPE_ERROR_NO_ARG,
+                .param = result->name ? result->name : "<collector>",
+                .value = result->raw[i]
+            });
+            return parse_code;
+        }
+    }
+    result->raw = NULL;
+    return HOPE_SUCCESS_CODE;
+}
+
+//
+// hope_table_t functions
+//
+
+// Get the capacity of the table index for a set with the given amount of parameters
+size_t hope_table_index_cap(size_t nparams){
+    if(nparams == 0)
+        return 0;
+    size_t cap = 2;
+    while(cap < nparams * 2)
+        cap *= 2;
+    return cap;
+}
+
+// Fill a parameter record of the table, which resolves the type of the parameter once
+void hope_table_param_init(hope_table_param_t *record, const hope_param_t *param){
+    *record = (hope_table_param_t){
+        .name = param->name,
+        .help = param->help,
+        .type = param->type,
+        .nargs = param->nargs,
+        .absent = { .name = param->name, .type = param->type }
+    };
+    if(param->name)
+        record->hash = hope_hash(param->name, SIZE_MAX, &record->len);
+    // the type was checked when the parameter was added, so every parameter takes one of these
+    switch(param->type){
+        case HOPE_TYPE_SWITCH:
+            break;
+        case HOPE_TYPE_INTEGER:
+            record->size = sizeof(long int);
+            record->parse = hope_parse_integer_into_result;
+            break;
+        case HOPE_TYPE_DOUBLE:
+            record->size = sizeof(double);
+            record->parse = hope_parse_double_into_result;
+            break;
+        case HOPE_TYPE_STRING:
+            record->size = sizeof(char*);
+            record->parse = hope_parse_string_into_result;
+            break;
+    }
+    // the default is handed out like a single value that was passed, without being stored by any parse
+    if(param->has_default){
+        record->default_value = param->default_value;
+        record->absent.count = 1;
+        if(param->type == HOPE_TYPE_INTEGER)
+            record->absent.value.integers = &record->default_value.integer;
+        else if(param->type == HOPE_TYPE_DOUBLE)
+            record->absent.value.doubles = &record->default_value._double;
+        else
+            record->absent.value.strings = &record->default_value.string;
+    }
+}
+
+// Check if the argument starts like a number: an optional sign followed by a digit, or by a . and a digit
+bool hope_looks_numeric(const char *arg){
+    if(arg[0] == '-' || arg[0] == '+')
+        arg++;
+    if(arg[0] == '.')
+        arg++;
+    return arg[0] >= '0' && arg[0] <= '9';
+}
+
+// Check if the argument may be a long parameter name or an abbreviation of one
+bool hope_is_long_name(const char *arg){
+    return arg[0] == '-' && arg[1] == '-' && arg[2] != '\0';
+}
+
+// Get the amount of trie nodes a set needs at most, the root and a node for every character after the -- of a long name
+size_t hope_trie_size(const hope_set_t *set){
+    size_t nnodes = 1;
+    for(size_t i = 0; i < set->nparams; i++){
+        if(hope_is_long_name(set->params[i].name))
+            nnodes += strlen(set->params[i].name) - 2;
+    }
+    return nnodes;
+}
+
+// Count what the table of the sets is made of
+void hope_table_count(const hope_set_t *sets, size_t nsets, size_t *nrecords, size_t *nslots, size_t *nwords, size_t *nnodes){
+    *nrecords = *nslots = *nwords = *nnodes = 0;
+    for(size_t i = 0; i < nsets; i++){
+        *nrecords += sets[i].nparams + (sets[i].collector ? 1 : 0);
+        *nslots += hope_table_index_cap(sets[i].nparams);
+        *nwords += (sets[i].nparams + 63) / 64;
+        *nnodes += hope_trie_size(sets + i);
+    }
+}
+
+// Get the size of the table of the sets in bytes
+size_t hope_table_size(const hope_set_t *sets, size_t nsets){
+    size_t nrecords, nslots, nwords, nnodes;
+    hope_table_count(sets, nsets, &nrecords, &nslots, &nwords, &nnodes);
+    return sizeof(hope_table_t) +
+           nsets * sizeof(hope_table_set_t) +
+           nrecords * sizeof(hope_table_param_t) +
+           nslots * sizeof(hope_slot_t) +
+           nwords * sizeof(uint64_t) +
+           nnodes * sizeof(hope_trie_node_t);
+}
+
+// Add the long name of the parameter at the given position to the trie, whose nodes are zeroed past nnodes
+void hope_trie_insert(hope_trie_node_t *trie, uint32_t *nnodes, const char *name, size_t index){
+    uint32_t node = 0;
+    for(const char *c = name + 2; *c; c++){
+        unsigned char key = (unsigned char)*c;
+        uint32_t *link = &trie[node].child;
+        while(*link != 0 && trie[*link].c < key)
+            link = &trie[*link].sibling;
+        if(*link == 0 || trie[*link].c != key){
+            uint32_t next = (*nnodes)++;
+            trie[next].c = key;
+            trie[next].sibling = *link;
+            *link = next;
+        }
+        node = *link;
+        if(trie[node].param == 0)
+            trie[node].param = (uint32_t)index + 1;
+        else if(trie[node].param != (uint32_t)index + 1)
+            trie[node].param = HOPE_TRIE_AMBIGUOUS;
+    }
+    trie[node].end = (uint32_t)index + 1;
+}
+
+// Walk down the trie along the first len characters of a long name, returns false if no name continues that way
+bool hope_trie_walk(const hope_table_set_t *set, const char *arg, size_t len, uint32_t *node){
+    const hope_trie_node_t *trie = set->trie;
+    *node = 0;
+    for(size_t i = 2; i < len; i++){
+        unsigned char key = (unsigned char)arg[i];
+        uint32_t next = trie[*node].child;
+        while(next != 0 && trie[next].c < key)
+            next = trie[next].sibling;
+        if(next == 0 || trie[next].c != key)
+            return false;
+        *node = next;
+    }
+    return true;
+}
+
+/* Resolve an abbreviation made of the first len characters of the argument in a single walk down the trie
+ * Returns the position of the parameter + 1, 0 if it abbreviates no name or HOPE_TRIE_AMBIGUOUS.
+ */
+uint32_t hope_trie_search(const hope_table_set_t *set, const char *arg, size_t len){
+    uint32_t node;
+    if(!hope_is_long_name(arg) || len <= 2 || !hope_trie_walk(set, arg, len, &node))
+        return 0;
+    return set->trie[node].param;
+}
+
+/* Build the table of the sets in mem, which has to be zeroed and hope_table_size bytes large
+ * The table is laid out as [hope_table_t][sets][parameter records][index slots][required bitmasks][trie nodes]
+ */
+hope_table_t *hope_table_build(void *mem, const hope_set_t *sets, size_t nsets){
+    size_t nrecords, nslots, nwords, nnodes;
+    hope_table_count(sets, nsets, &nrecords, &nslots, &nwords, &nnodes);
+    hope_table_t *table = (hope_table_t*) mem;
+    hope_table_set_t *table_sets = (hope_table_set_t*)(table + 1);
+    hope_table_param_t *records = (hope_table_param_t*)(table_sets + nsets);
+    hope_slot_t *slots = (hope_slot_t*)(records + nrecords);
+    uint64_t *words = (uint64_t*)(slots + nslots);
+    hope_trie_node_t *nodes = (hope_trie_node_t*)(words + nwords);
+    table->size = hope_table_size(sets, nsets);
+    table->sets = table_sets;
+    table->nsets = nsets;
+
+    for(size_t i = 0; i < nsets; i++){
+        const hope_set_t *set = sets + i;
+        hope_table_set_t *table_set = table_sets + i;
+        table_set->name = set->name;
+        table_set->nparams = set->nparams;
+        table_set->params = records;
+        table_set->index = slots;
+        table_set->index_cap = hope_table_index_cap(set->nparams);
+        table_set->required = words;
+        table_set->trie = nodes;
+        uint32_t ntrie = 1;
+        for(size_t j = 0; j < set->nparams; j++){
+            hope_table_param_t *record = records + j;
+            hope_table_param_init(record, set->params + j);
+            if(record->nargs == HOPE_ARGC_MORE || record->nargs > HOPE_ARGC_NONE)
+                words[j / 64] |= (uint64_t)1 << (j % 64);
+            // an empty argument list can only match sets without required parameters or switches
+            if(record->nargs >= HOPE_ARGC_MORE)
+                table_set->needs_args = true;
+            unsigned char first = (unsigned char)record->name[0];
+            table_set->first_chars[first / 64] |= (uint64_t)1 << (first % 64);
+            if(hope_looks_numeric(record->name))
+                table->numeric_names = true;
+            if(record->len > table_set->max_len)
+                table_set->max_len = record->len;
+            size_t mask = table_set->index_cap - 1;
+            size_t k = (size_t)record->hash & mask;
+            while(slots[k].param != 0){
+                // only the names of a static set were not checked when they were added
+                if(slots[k].hash == record->hash && slots[k].len == record->len && !strcmp(records[slots[k].param - 1].name, record->name))
+                    table_set->duplicate = record->name;
+                k = (k + 1) & mask;
+            }
+            slots[k] = (hope_slot_t){
+                .hash = record->hash,
+                .len = record->len,
+                .param = j + 1
+            };
+            if(hope_is_long_name(record->name))
+                hope_trie_insert(nodes, &ntrie, record->name, j);
+        }
+        if(set->collector){
+            hope_table_param_init(records + set->nparams, set->collector);
+            table_set->collector = records + set->nparams;
+            // the collector is only checked when the set has no named parameters
+            if(set->nparams == 0 && set->collector->nargs >= HOPE_ARGC_MORE && set->collector->nargs != 0)
+                table_set->needs_args = true;
+        }
+        for(size_t j = 0; j < 4; j++)
+            table->first_chars[j] |= table_set->first_chars[j];
+        if(table_set->max_len > table->max_len)
+            table->max_len = table_set->max_len;
+        records += set->nparams + (set->collector ? 1 : 0);
+        slots += table_set->index_cap;
+        words += (set->nparams + 63) / 64;
+        nodes += hope_trie_size(set);
+    }
+    return table;
+}
+
+#ifndef HOPE_NO_MALLOC
+// Compile the sets into a table, which is a single allocation
+hope_table_t *hope_compile_sets(hope_alloc_t *alloc, const hope_set_t *sets, size_t nsets){
+    size_t size = hope_table_size(sets, nsets);
+    void *mem = hope_malloc(alloc, size);
+    if(!mem)
+        return NULL;
+    memset(mem, 0, size);
+    return hope_table_build(mem, sets, nsets);
+}
+#endif
+
+// Check that no compiled set holds a name twice, which only the index of a static set can show
+int hope_check_table_names(const hope_table_t *table, hope_error_t *error){
+    for(size_t i = 0; i < table->nsets; i++){
+        if(table->sets[i].duplicate){
+            *error = (hope_error_t){ .code = HOPE_PARAMADD_ERR_DUPLICATE_CODE, .arg = HOPE_ERROR_NO_ARG, .param = table->sets[i].duplicate, .set = table->sets[i].name };
+            return HOPE_PARAMADD_ERR_DUPLICATE_CODE;
+        }
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Compile the sets of the parser into its table, replacing an older table
+HOPEDEF int hope_compile(hope_t *hope){
+    // hope_add_set checked the static sets, only their names can still clash
+    hope_error_t error;
+    #ifdef HOPE_NO_MALLOC
+    // the table takes the start of the buffer and the arena the rest, which drops all results
+    size_t size = (hope_table_size(hope->sets, hope->nsets) + HOPE_ARENA_ALIGN - 1) & ~(size_t)(HOPE_ARENA_ALIGN - 1);
+    if(!hope->buffer || size > hope->buffer_size){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_CAPACITY_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_CAPACITY_CODE;
+    }
+    memset(hope->buffer, 0, size);
+    hope_table_t *table = hope_table_build(hope->buffer, hope->sets, hope->nsets);
+    hope_arena_use_buffer(&hope->arena, (char*)hope->buffer + size, hope->buffer_size - size);
+    hope->results = NULL;
+    hope->nresults = 0;
+    hope->param_results = NULL;
+    if(hope_check_table_names(table, &error) != HOPE_SUCCESS_CODE){
+        hope->table = NULL;
+        hope_report_error(hope->flags, &hope->error, error);
+        return error.code;
+    }
+    #else
+    hope_table_t *table = hope_compile_sets(&hope->alloc, hope->sets, hope->nsets);
+    if(!table){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
         return HOPE_ERR_ALLOC_FAILED_CODE;
     }
-    hope->sets[hope->nsets] = set;
-    hope->nsets++;
+    if(hope_check_table_names(table, &error) != HOPE_SUCCESS_CODE){
+        hope_dealloc(&hope->alloc, table, table->size);
+        hope_report_error(hope->flags, &hope->error, error);
+        return error.code;
+    }
+    if(hope->table)
+        hope_dealloc(&hope->alloc, hope->table, hope->table->size);
+    #endif
+    hope->table = table;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Search for the parameter of the compiled set with the given name, hash and length
+const hope_table_param_t *hope_table_search_hashed(const hope_table_set_t *set, const char *name, uint64_t hash, size_t len){
+    if(set->nparams == 0)
+        return NULL;
+    size_t mask = set->index_cap - 1;
+    for(size_t i = (size_t)hash & mask;; i = (i + 1) & mask){
+        const hope_slot_t *slot = set->index + i;
+        if(slot->param == 0)
+            return NULL;
+        if(slot->hash == hash && slot->len == len &&
+           memcmp(set->params[slot->param - 1].name, name, len) == 0)
+            return set->params + slot->param - 1;
+    }
+}
+
+// Search for the parameter of the compiled set with the given name
+const hope_table_param_t *hope_table_search(const hope_table_set_t *set, const char *name){
+    // only the collector is unnamed and it is never part of the index
+    if(name == NULL || set->nparams == 0 || !hope_first_char_in(set->first_chars, name[0]))
+        return NULL;
+    size_t len;
+    uint64_t hash = hope_hash(name, set->max_len, &len);
+    if(name[len] != '\0')
+        return NULL;
+    return hope_table_search_hashed(set, name, hash, len);
+}
+
+// Check if the argument is the -- separator
+bool hope_is_separator(const char *arg){
+    return arg[0] == '-' && arg[1] == '-' && arg[2] == '\0';
+}
+
+/* Classify an argument against the name filters of the table
+ * Only candidates are hashed, and no further than the longest name, so values are never measured. Matching
+ * abbreviations, --name=value and clusters looks at the rest of an argument starting with a - when it gets to it.
+ */
+void hope_classify(const hope_table_t *table, const char *arg, hope_token_t *token){
+    token->kind = 0;
+    token->hash = 0;
+    token->len = 0;
+    if(arg[0] == '-')
+        token->kind |= arg[1] != '-' ? HOPE_TOKEN_SHORT : (arg[2] == '\0' ? HOPE_TOKEN_SEPARATOR : HOPE_TOKEN_LONG);
+    if(token->kind & HOPE_TOKEN_SEPARATOR || !hope_first_char_in(table->first_chars, arg[0]))
+        return;
+    if(hope_looks_numeric(arg)){
+        token->kind |= HOPE_TOKEN_NUMERIC;
+        if(!table->numeric_names)
+            return;
+    }
+    size_t len;
+    uint64_t hash = hope_hash(arg, table->max_len, &len);
+    if(arg[len] == '\0'){
+        token->hash = hash;
+        token->len = len;
+        token->kind |= HOPE_TOKEN_CANDIDATE;
+    }
+}
+
+/* Classify all arguments once for the walks of every set, the table of tokens is allocated from the arena
+ * Arguments are classified from the last one, so the runs of values are counted on the way. An argument that is no
+ * candidate and does not start with a - names no parameter of any set, the walks pass its whole run at once.
+ */
+hope_token_t *hope_tokenize(const hope_table_t *table, hope_arena_t *arena, char *args[]){
+    size_t nargs = 0;
+    while(args[nargs] != NULL)
+        nargs++;
+    hope_token_t *tokens = (hope_token_t*) hope_arena_alloc(arena, (nargs + 1) * sizeof(hope_token_t));
+    if(!tokens)
+        return NULL;
+    tokens[nargs] = (hope_token_t){0};
+    for(size_t i = nargs; i-- > 0;){
+        hope_classify(table, args[i], tokens + i);
+        bool value = !(tokens[i].kind & (HOPE_TOKEN_CANDIDATE | HOPE_TOKEN_SEPARATOR | HOPE_TOKEN_SHORT | HOPE_TOKEN_LONG));
+        tokens[i].run = value ? tokens[i + 1].run + 1 : 0;
+    }
+    return tokens;
+}
+
+// Amount of arguments a walk moves past at the token: the run of values it starts, or the argument itself
+size_t hope_token_span(const hope_token_t *token){
+    return token->run > 0 ? token->run : 1;
+}
+
+// Search for the parameter of the compiled set a classified argument names exactly
+const hope_table_param_t *hope_table_search_token(const hope_table_set_t *set, const char *arg, const hope_token_t *token){
+    if(!(token->kind & HOPE_TOKEN_CANDIDATE) || token->len > set->max_len || !hope_first_char_in(set->first_chars, arg[0]))
+        return NULL;
+    return hope_table_search_hashed(set, arg, token->hash, token->len);
+}
+
+/* Parsing state of a single set while the arguments are walked
+ * Sets are walked twice: first only counting, which is enough to rule most sets out and adds up runs of values from
+ * their tokens, then filling, where every value array is allocated once at its exact size and the values are converted.
+ * fill: whether values are stored, otherwise only counted
+ * param: the parameter currently receiving values (NULL if there is none)
+ * result: the pending result of param
+ * collector_result: the values passed to the collector so far
+ * results, nresults: the results pushed so far
+ * param_results: the first result of every parameter in parameter order, the collector's comes last
+ * npushed: the amount of results pushed
+ * done: set once the collector is full, the remaining arguments are then ignored
+ * args: the arguments walked, positions in errors are relative to them
+ * error: what caused the set to fail
+ * arena: where the results of the set are allocated from when filling
+ * stream, user: when streaming, the callback values are passed to instead of being stored
+ * stopped: set when the callback stopped the parse, its code is handed back without reporting it as an error
+ * seen: when filling or streaming, a bit for every parameter that was passed
+ * lazy: when filling, store the strings of integers and doubles instead of converting them
+ * flags: the HOPE_FLAG_ values deciding how arguments name parameters
+ */
+typedef struct {
+    bool fill;
+    bool lazy;
+    unsigned flags;
+    hope_arena_t *arena;
+    hope_stream_cb_t stream;
+    void *user;
+    bool stopped;
+    uint64_t *seen;
+    const hope_table_param_t *param;
+    hope_result_t result;
+    hope_result_t collector_result;
+    hope_result_t *results;
+    size_t nresults;
+    hope_result_t **param_results;
+    size_t npushed;
+    bool done;
+    char **args;
+    hope_error_t error;
+} hope_set_state_t;
+
+// Count the trailing zero bits of a non-zero word
+unsigned hope_ctz64(uint64_t word){
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(word);
+#else
+    unsigned n = 0;
+    while(!(word & 1)){
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* How an argument that is no exact parameter name refers to a parameter of a set, depending on the parser's flags
+ * param: the parameter (NULL if the argument is a value)
+ * value: the value attached to the name, pointing into the argument itself (NULL if there is none)
+ * cluster: whether value holds further short names instead, e.g. "vf" of "-xvf"
+ */
+typedef struct {
+    const hope_table_param_t *param;
+    const char *value;
+    bool cluster;
+} hope_match_t;
+
+// Search the short name -c in the set, c being a character of a cluster
+const hope_table_param_t *hope_table_search_short(const hope_table_set_t *set, char c){
+    const char name[3] = { '-', c, '\0' };
+    return hope_table_search(set, name);
+}
+
+/* Match an argument as an abbreviation, as --name=value or as a cluster of short names.
+ * A cluster only counts if all of it resolves: switches, optionally ending in a parameter taking the rest
+ * as its value. Anything else stays a value. Returns HOPE_PARSE_ERR_AMBIGUOUS_CODE for an ambiguous abbreviation.
+ */
+int hope_match_arg(const hope_table_set_t *set, unsigned flags, const char *arg, const hope_token_t *token, hope_match_t *match){
+    *match = (hope_match_t){0};
+    if((token->kind & HOPE_TOKEN_LONG) && (flags & (HOPE_FLAG_PREFIX | HOPE_FLAG_EQUALS))){
+        const char *eq = flags & HOPE_FLAG_EQUALS ? strchr(arg + 2, '=') : NULL;
+        size_t len = eq ? (size_t)(eq - arg) : strlen(arg);
+        if(eq){
+            size_t hashed;
+            uint64_t hash = hope_hash(arg, len, &hashed);
+            match->param = hope_table_search_hashed(set, arg, hash, len);
+        }
+        if(!match->param && (flags & HOPE_FLAG_PREFIX)){
+            uint32_t found = hope_trie_search(set, arg, len);
+            if(found == HOPE_TRIE_AMBIGUOUS)
+                return HOPE_PARSE_ERR_AMBIGUOUS_CODE;
+            if(found != 0)
+                match->param = set->params + found - 1;
+        }
+        if(match->param && eq)
+            match->value = eq + 1;
+    } else if((flags & HOPE_FLAG_CLUSTER) && (token->kind & HOPE_TOKEN_SHORT) && arg[1] && arg[2]){
+        const hope_table_param_t *param = hope_table_search_short(set, arg[1]);
+        for(const char *c = arg + 2; param && param->type == HOPE_TYPE_SWITCH && *c; c++){
+            const hope_table_param_t *next = hope_table_search_short(set, *c);
+            if(!next)
+                return HOPE_SUCCESS_CODE;
+            if(next->type != HOPE_TYPE_SWITCH)
+                break;
+        }
+        if(param){
+            match->param = param;
+            match->value = arg + 2;
+            match->cluster = param->type == HOPE_TYPE_SWITCH;
+        }
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Check if the classified argument names a parameter of the set in any way the flags allow
+bool hope_names_param(const hope_table_set_t *set, unsigned flags, const char *arg, const hope_token_t *token){
+    hope_match_t match;
+    if(hope_table_search_token(set, arg, token))
+        return true;
+    // only arguments starting with a - can be matched otherwise
+    if(!(flags & (HOPE_FLAG_PREFIX | HOPE_FLAG_EQUALS | HOPE_FLAG_CLUSTER)) || !(token->kind & (HOPE_TOKEN_SHORT | HOPE_TOKEN_LONG)))
+        return false;
+    return hope_match_arg(set, flags, arg, token, &match) != HOPE_SUCCESS_CODE || match.param != NULL;
+}
+
+// Most values a parameter takes before it is closed
+size_t hope_nargs_limit(const hope_table_param_t *param){
+    return param->nargs == HOPE_ARGC_OPT ? 1 : (param->nargs >= 0 ? (size_t)param->nargs : SIZE_MAX);
+}
+
+// Count the values passed to a parameter: they end at the next parameter, the -- separator or the parameter's limit.
+// tokens classify args, taken values were attached to the parameter's name already. Runs of values are added whole.
+size_t hope_measure_run(const hope_table_set_t *set, const hope_table_param_t *param, char *args[], const hope_token_t *tokens, unsigned flags, size_t taken){
+    size_t limit = hope_nargs_limit(param);
+    size_t count = taken;
+    for(size_t i = 0; count < limit && args[i] != NULL; i += hope_token_span(tokens + i)){
+        if(tokens[i].run > 0){
+            count += tokens[i].run < limit - count ? tokens[i].run : limit - count;
+            continue;
+        }
+        if((tokens[i].kind & HOPE_TOKEN_SEPARATOR) || hope_names_param(set, flags, args[i], tokens + i))
+            break;
+        count++;
+    }
+    return count;
+}
+
+// Check if the set can match an empty argument list and prepare the state for counting the arguments
+int hope_parse_set_begin(const hope_table_set_t *set, hope_set_state_t *state, char *args[], unsigned flags){
+    *state = (hope_set_state_t){0};
+    state->args = args;
+    state->flags = flags;
+    if(args[0] == NULL && set->needs_args)
+        return HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Record what made the set fail, arg points at the argument responsible (NULL if none)
+int hope_parse_set_error(const hope_table_set_t *set, hope_set_state_t *state, int code, const hope_table_param_t *param, char **arg){
+    state->error = (hope_error_t){
+        .code = code,
+        .arg = arg && state->args ? (size_t)(arg - state->args) : HOPE_ERROR_NO_ARG,
+        .param = param ? (param->name ? param->name : "<collector>") : NULL,
+        .set = set->name,
+        .value = arg ? *arg : NULL
+    };
+    return code;
+}
+
+// Allocate room for count values of the parameter in the result, a lazy parse also needs room for their strings
+int hope_parse_set_alloc_values(hope_set_state_t *state, const hope_table_param_t *param, hope_result_t *result, size_t count){
+    result->value.strings = (const char**) hope_arena_alloc(state->arena, count * param->size);
+    if(!result->value.strings)
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    if(state->lazy && param->type != HOPE_TYPE_STRING){
+        result->raw = (const char**) hope_arena_alloc(state->arena, count * sizeof(const char*));
+        if(!result->raw)
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Prepare the state for filling, the counts of the counting walk size the result and collector arrays
+int hope_parse_set_begin_fill(const hope_table_set_t *set, hope_set_state_t *state, const hope_set_state_t *counted, hope_arena_t *arena, bool lazy){
+    *state = (hope_set_state_t){
+        .fill = true,
+        .lazy = lazy,
+        .flags = counted->flags,
+        .arena = arena,
+        .args = counted->args
+    };
+    // parameters that were not passed take no result, the getters fall back to the absent result of their record,
+    // the last slot is kept for the collector
+    size_t max_results = counted->npushed + 1;
+    size_t nwords = (set->nparams + 64) / 64;
+    state->results = (hope_result_t*) hope_arena_alloc(arena, max_results * sizeof(hope_result_t));
+    state->param_results = (hope_result_t**) hope_arena_alloc(arena, (set->nparams + 1) * sizeof(hope_result_t*));
+    state->seen = (uint64_t*) hope_arena_alloc(arena, nwords * sizeof(uint64_t));
+    if(!state->results || !state->param_results || !state->seen)
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    memset(state->param_results, 0, (set->nparams + 1) * sizeof(hope_result_t*));
+    memset(state->seen, 0, nwords * sizeof(uint64_t));
+    if(set->collector && counted->collector_result.count > 0)
+        return hope_parse_set_alloc_values(state, set->collector, &state->collector_result, counted->collector_result.count);
+    return HOPE_SUCCESS_CODE;
+}
+
+// Push a result for the parameter at the given position of the set (nparams for the collector),
+// when counting it is only counted
+void hope_push_parsed_result(hope_set_state_t *state, size_t param_index, const hope_result_t *result){
+    state->npushed++;
+    if(state->seen)
+        state->seen[param_index / 64] |= (uint64_t)1 << (param_index % 64);
+    if(state->fill){
+        state->results[state->nresults] = *result;
+        // getters return the first result of a parameter that was passed more than once
+        if(!state->param_results[param_index])
+            state->param_results[param_index] = state->results + state->nresults;
+        state->nresults++;
+    }
+}
+
+// Convert a value and hand it to the stream callback
+int hope_stream_value(const hope_table_set_t *set, hope_set_state_t *state, const char *str, const hope_table_param_t *param){
+    hope_value_t value = {
+        .name = param->name,
+        .index = param == set->collector ? HOPE_HANDLE_COLLECTOR : (size_t)(param - set->params),
+        .type = param->type
+    };
+    if(param->type == HOPE_TYPE_SWITCH){
+        value.value._switch = true;
+    } else {
+        // the parser stores into the first slot of a result, which is the value itself here
+        hope_result_t slot = { .value.strings = &value.value.string };
+        if(param->type == HOPE_TYPE_INTEGER)
+            slot.value.integers = &value.value.integer;
+        else if(param->type == HOPE_TYPE_DOUBLE)
+            slot.value.doubles = &value.value._double;
+        int parse_code = param->parse(str, &slot);
+        if(parse_code != HOPE_SUCCESS_CODE)
+            return parse_code;
+    }
+    int stream_code = state->stream(&value, state->user);
+    state->stopped = stream_code != HOPE_SUCCESS_CODE;
+    return stream_code;
+}
+
+// Pass a value to a result, when counting it is only counted and when streaming it goes to the callback
+int hope_parse_set_value(const hope_table_set_t *set, hope_set_state_t *state, const char *str, const hope_table_param_t *param, hope_result_t *result){
+    if(state->stream){
+        int stream_code = hope_stream_value(set, state, str, param);
+        if(stream_code != HOPE_SUCCESS_CODE)
+            return stream_code;
+    } else if(state->fill){
+        if(!result->raw)
+            return param->parse(str, result);
+        result->raw[result->count] = str;
+    }
+    result->count++;
+    return HOPE_SUCCESS_CODE;
+}
+
+// Push the result of the parameter that is currently receiving values
+void hope_parse_set_close_param(const hope_table_set_t *set, hope_set_state_t *state){
+    if(state->param){
+        hope_push_parsed_result(state, (size_t)(state->param - set->params), &state->result);
+        state->result = (hope_result_t){0};
+        state->param = NULL;
+    }
+}
+
+// Push the result of a switch that was passed
+int hope_parse_set_switch(const hope_table_set_t *set, hope_set_state_t *state, char **arg, const hope_table_param_t *param){
+    hope_result_t result = {
+        .name = param->name,
+        .type = param->type,
+        .value._switch = 1
+    };
+    if(state->stream){
+        int parse_code = hope_stream_value(set, state, NULL, param);
+        if(parse_code != HOPE_SUCCESS_CODE)
+            return hope_parse_set_error(set, state, parse_code, param, arg);
+    }
+    hope_push_parsed_result(state, (size_t)(param - set->params), &result);
+    return HOPE_SUCCESS_CODE;
+}
+
+/* Feed the argument at arg into the set. token classifies it and param is the parameter of the set it names exactly, if any.
+ * The tokens after token are only read while filling, to measure the values of a parameter.
+ */
+int hope_parse_set_step(const hope_table_set_t *set, hope_set_state_t *state, char **arg, const hope_token_t *token, const hope_table_param_t *param){
+    int parse_code;
+    const char *value = NULL;
+    if(state->done)
+        return HOPE_SUCCESS_CODE;
+    if(token->kind & HOPE_TOKEN_SEPARATOR){
+        // the -- separator ends the arguments of the current parameter
+        hope_parse_set_close_param(set, state);
+        return HOPE_SUCCESS_CODE;
+    }
+    if(!param && (state->flags & (HOPE_FLAG_PREFIX | HOPE_FLAG_EQUALS | HOPE_FLAG_CLUSTER)) &&
+       (token->kind & (HOPE_TOKEN_SHORT | HOPE_TOKEN_LONG))){
+        hope_match_t match;
+        parse_code = hope_match_arg(set, state->flags, *arg, token, &match);
+        if(parse_code != HOPE_SUCCESS_CODE)
+            return hope_parse_set_error(set, state, parse_code, NULL, arg);
+        param = match.param;
+        value = match.value;
+        if(match.cluster){
+            hope_parse_set_close_param(set, state);
+            // every name but the last of a cluster is a switch, the last one may take the rest of the argument
+            for(; param->type == HOPE_TYPE_SWITCH && *value; value++){
+                parse_code = hope_parse_set_switch(set, state, arg, param);
+                if(parse_code != HOPE_SUCCESS_CODE)
+                    return parse_code;
+                param = hope_table_search_short(set, *value);
+            }
+            if(*value == '\0')
+                value = NULL;
+        }
+    }
+    if(param){
+        hope_parse_set_close_param(set, state);
+        if(value && (param->type == HOPE_TYPE_SWITCH || param->nargs == HOPE_ARGC_NONE))
+            return hope_parse_set_error(set, state, HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE, param, arg);
+        if(param->type == HOPE_TYPE_SWITCH){
+            return hope_parse_set_switch(set, state, arg, param);
+        } else if(param->nargs != HOPE_ARGC_NONE){
+            state->param = param;
+            state->result.name = param->name;
+            state->result.type = param->type;
+            if(state->fill){
+                size_t count = hope_measure_run(set, param, arg + 1, token + 1, state->flags, value ? 1 : 0);
+                if(count > 0 && hope_parse_set_alloc_values(state, param, &state->result, count) != HOPE_SUCCESS_CODE)
+                    return HOPE_ERR_ALLOC_FAILED_CODE;
+            }
+        }
+        // an attached value is passed like the argument after the name
+        if(!value)
+            return HOPE_SUCCESS_CODE;
+    }
+    if(state->param){
+        parse_code = hope_parse_set_value(set, state, value ? value : *arg, state->param, &state->result);
+        if(parse_code != HOPE_SUCCESS_CODE)
+            return hope_parse_set_error(set, state, parse_code, state->param, arg);
+        if(state->param->nargs == HOPE_ARGC_OPT || state->param->nargs == (int)state->result.count)
+            hope_parse_set_close_param(set, state);
+        return HOPE_SUCCESS_CODE;
+    }
+    if(!set->collector)
+        return hope_parse_set_error(set, state, HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE, NULL, arg);
+    if((set->collector->nargs == HOPE_ARGC_OPT && state->collector_result.count != 0) ||
+        set->collector->nargs == (int)state->collector_result.count){
+        state->done = true;
+        return HOPE_SUCCESS_CODE;
+    }
+    parse_code = hope_parse_set_value(set, state, *arg, set->collector, &state->collector_result);
+    if(parse_code != HOPE_SUCCESS_CODE)
+        return hope_parse_set_error(set, state, parse_code, set->collector, arg);
+    return HOPE_SUCCESS_CODE;
+}
+
+/* Feed the run of count values starting at arg into the set, they name no parameter of any set.
+ * The open parameter takes values up to its limit and the collector the rest. While counting, the run is added up
+ * without reading the values.
+ */
+int hope_parse_set_run(const hope_table_set_t *set, hope_set_state_t *state, char **arg, size_t count){
+    while(count > 0 && !state->done){
+        const hope_table_param_t *param = state->param ? state->param : set->collector;
+        hope_result_t *result = state->param ? &state->result : &state->collector_result;
+        if(!param)
+            return hope_parse_set_error(set, state, HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE, NULL, arg);
+        size_t limit = hope_nargs_limit(param);
+        if(result->count == limit){
+            // only the collector is left open once it is full
+            state->done = true;
+            break;
+        }
+        size_t take = count < limit - result->count ? count : limit - result->count;
+        if(!state->fill && !state->stream){
+            result->count += take;
+        } else {
+            for(size_t i = 0; i < take; i++){
+                int parse_code = hope_parse_set_value(set, state, arg[i], param, result);
+                if(parse_code != HOPE_SUCCESS_CODE)
+                    return hope_parse_set_error(set, state, parse_code, param, arg + i);
+            }
+        }
+        arg += take;
+        count -= take;
+        if(state->param && result->count == limit)
+            hope_parse_set_close_param(set, state);
+    }
+    return HOPE_SUCCESS_CODE;
+}
+
+// Feed the argument at arg into the set, together with the run of values it starts
+int hope_parse_set_feed(const hope_table_set_t *set, hope_set_state_t *state, char **arg, const hope_token_t *token){
+    if(token->run > 0)
+        return hope_parse_set_run(set, state, arg, token->run);
+    return hope_parse_set_step(set, state, arg, token, hope_table_search_token(set, *arg, token));
+}
+
+// Validate the walked arguments against the set and complete its results
+int hope_parse_set_finish(const hope_table_set_t *set, hope_set_state_t *state){
+    hope_parse_set_close_param(set, state);
+    if(set->collector){
+        if ((set->collector->nargs == HOPE_ARGC_MORE && state->collector_result.count <= 0) ||
+            (set->collector->nargs > HOPE_ARGC_NONE && set->collector->nargs != (int)state->collector_result.count))
+            return hope_parse_set_error(set, state, HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE, set->collector, NULL);
+    }
+    // counting does not track the parameters passed, the set is checked once it is filled
+    if(!state->seen)
+        return HOPE_SUCCESS_CODE;
+    for(size_t w = 0; w < (set->nparams + 63) / 64; w++){
+        uint64_t missing = set->required[w] & ~state->seen[w];
+        if(missing)
+            return hope_parse_set_error(set, state, HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE, set->params + w * 64 + hope_ctz64(missing), NULL);
+    }
+    // like the parameters, a collector without values falls back to its absent result
+    if(state->fill && set->collector && state->collector_result.count > 0){
+        state->collector_result.type = set->collector->type;
+        hope_push_parsed_result(state, set->nparams, &state->collector_result);
+    }
     return HOPE_SUCCESS_CODE;
 }
 
-// Search for the parameter with the given name
-hope_param_t *hope_search_param(hope_set_t *set, const char *name){
-    for(size_t i = 0; i < set->nparams; i++){
-        hope_param_t *cur_param = set->params + i;
-        if(name == NULL){
-            if(cur_param->name == NULL)
-                return cur_param;
-        } else if(strcmp(cur_param->name, name) == 0){
-            return cur_param;
-        }
+// Complete the error of a set that did not match, its results stay in the arena until it is freed
+void hope_parse_set_fail(const hope_table_set_t *set, hope_set_state_t *state, int parse_code){
+    // failures that were not recorded where they happened, e.g. running out of memory, only have a code
+    if(state->error.code != parse_code)
+        state->error = (hope_error_t){ .code = parse_code, .arg = HOPE_ERROR_NO_ARG, .set = set->name };
+    #ifdef HOPE_DEBUG
+    char msg[256];
+    hope_format_error(&state->error, msg, sizeof(msg));
+    hope_eprintf(HOPE_FMT_DEFAULT "\n", HOPE_PARSE_ERR_GENERIC_MSG, msg);
+    #endif
+}
+
+// Walk the arguments a second time for a set that survived counting, now storing its results
+int hope_parse_set_fill(const hope_table_set_t *set, const hope_set_state_t *counted, char *args[], const hope_token_t *tokens, hope_arena_t *arena, bool lazy, hope_set_state_t *state){
+    int parse_code = hope_parse_set_begin_fill(set, state, counted, arena, lazy);
+    for(size_t i = 0; args[i] != NULL && parse_code == HOPE_SUCCESS_CODE && !state->done; i += hope_token_span(tokens + i))
+        parse_code = hope_parse_set_feed(set, state, args + i, tokens + i);
+    if(parse_code == HOPE_SUCCESS_CODE)
+        parse_code = hope_parse_set_finish(set, state);
+    if(parse_code != HOPE_SUCCESS_CODE)
+        hope_parse_set_fail(set, state, parse_code);
+    return parse_code;
+}
+
+// Count and fill a single compiled set
+int hope_parse_table_set(const hope_table_set_t *set, char *args[], const hope_token_t *tokens, hope_arena_t *arena, unsigned flags, hope_set_state_t *state){
+    hope_set_state_t counted;
+    int parse_code = hope_parse_set_begin(set, &counted, args, flags);
+    for(size_t i = 0; args[i] != NULL && parse_code == HOPE_SUCCESS_CODE && !counted.done; i += hope_token_span(tokens + i))
+        parse_code = hope_parse_set_feed(set, &counted, args + i, tokens + i);
+    if(parse_code == HOPE_SUCCESS_CODE)
+        parse_code = hope_parse_set_finish(set, &counted);
+    if(parse_code != HOPE_SUCCESS_CODE){
+        hope_parse_set_fail(set, &counted, parse_code);
+        *state = counted;
+        return parse_code;
+    }
+    return hope_parse_set_fill(set, &counted, args, tokens, arena, flags & HOPE_FLAG_LAZY, state);
+}
+
+// Parse the command line arguments and store the results in the hope data structure
+HOPEDEF int hope_parse_set(hope_t *hope, hope_set_t *set, char *args[]){
+    set->results = NULL;
+    set->nresults = 0;
+    set->param_results = NULL;
+    // a single set is not worth keeping a table around, it is compiled into the arena for this call only
+    hope->arena.alloc = &hope->alloc;
+    hope->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+    hope_error_t error;
+    if(set->is_static && hope_check_static_set(set, &error) != HOPE_SUCCESS_CODE){
+        hope_report_error(hope->flags, &hope->error, error);
+        return error.code;
+    }
+    size_t size = hope_table_size(set, 1);
+    void *mem = hope_arena_alloc(&hope->arena, size);
+    if(!mem){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    memset(mem, 0, size);
+    hope_table_t *table = hope_table_build(mem, set, 1);
+    if(hope_check_table_names(table, &error) != HOPE_SUCCESS_CODE){
+        hope_report_error(hope->flags, &hope->error, error);
+        return error.code;
+    }
+    hope_token_t *tokens = hope_tokenize(table, &hope->arena, args);
+    if(!tokens){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    hope_set_state_t state;
+    int parse_code = hope_parse_table_set(table->sets, args, tokens, &hope->arena, hope->flags, &state);
+    if(parse_code == HOPE_SUCCESS_CODE){
+        set->results = state.results;
+        set->nresults = state.nresults;
+        set->param_results = state.param_results;
+    } else {
+        hope_report_error(hope->flags, &hope->error, state.error);
+    }
+    return parse_code;
+}
+
+/* All sets are counted against the arguments in a single walk. Every set keeps its own state
+ * and a bitmask tracks the sets that are still viable, so a set is dropped as soon as an argument
+ * rules it out and each argument is hashed only once for all of them. A run of values is passed to every set at once.
+ * The viable sets are then filled in the order they were added and the first one that matches wins.
+ */
+int hope_parse_table(const hope_table_t *table, hope_parse_ctx_t *ctx, char *args[]){
+    unsigned flags = ctx->hope->flags;
+    ctx->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+    if(table->nsets == 0){
+        hope_report_error(flags, &ctx->error, (hope_error_t){ .code = HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+    }
+    if(flags & HOPE_FLAG_RESPONSE_FILES){
+        hope_error_t error;
+        int expand_code = hope_expand_response_files(&ctx->arena, &ctx->mappings, args, &args, &error);
+        if(expand_code != HOPE_SUCCESS_CODE){
+            hope_report_error(flags, &ctx->error, error);
+            return expand_code;
+        }
+    }
+    size_t nwords = (table->nsets + 63) / 64;
+    hope_set_state_t *states = (hope_set_state_t*) hope_arena_alloc(&ctx->arena, table->nsets * sizeof(hope_set_state_t));
+    uint64_t *viable = (uint64_t*) hope_arena_alloc(&ctx->arena, nwords * sizeof(uint64_t));
+    // every argument is classified and hashed once, all walks of all sets read the tokens
+    hope_token_t *tokens = hope_tokenize(table, &ctx->arena, args);
+    if(!states || !viable || !tokens){
+        hope_report_error(flags, &ctx->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    memset(viable, 0, nwords * sizeof(uint64_t));
+    size_t nviable = 0;
+    for(size_t i = 0; i < table->nsets; i++){
+        int parse_code = hope_parse_set_begin(table->sets + i, states + i, args, flags);
+        if(parse_code == HOPE_SUCCESS_CODE){
+            viable[i / 64] |= (uint64_t)1 << (i % 64);
+            nviable++;
+        } else {
+            hope_parse_set_fail(table->sets + i, states + i, parse_code);
+        }
+    }
+
+    for(size_t i = 0; args[i] != NULL && nviable > 0; i += hope_token_span(tokens + i)){
+        size_t nactive = 0;
+        for(size_t w = 0; w < nwords; w++){
+            uint64_t bits = viable[w];
+            while(bits){
+                size_t s = w * 64 + hope_ctz64(bits);
+                bits &= bits - 1;
+                const hope_table_set_t *set = table->sets + s;
+                int parse_code = hope_parse_set_feed(set, states + s, args + i, tokens + i);
+                if(parse_code != HOPE_SUCCESS_CODE){
+                    hope_parse_set_fail(set, states + s, parse_code);
+                    viable[w] &= ~((uint64_t)1 << (s % 64));
+                    nviable--;
+                } else if(!states[s].done){
+                    nactive++;
+                }
+            }
+        }
+        // every set left has a full collector and ignores the remaining arguments
+        if(nactive == 0)
+            break;
+    }
+
+    // when no set matches, the one that got furthest is reported: a set that only failed converting a value
+    // comes before one that failed the checks after the walk, then the position the others failed at decides
+    const hope_error_t *furthest = NULL;
+    size_t furthest_rank = 0;
+    for(size_t i = 0; i < table->nsets; i++){
+        const hope_table_set_t *set = table->sets + i;
+        size_t rank;
+        if(!(viable[i / 64] & ((uint64_t)1 << (i % 64)))){
+            rank = states[i].error.arg == HOPE_ERROR_NO_ARG ? 0 : states[i].error.arg + 1;
+        } else {
+            hope_set_state_t state;
+            int parse_code = hope_parse_set_finish(set, states + i);
+            if(parse_code == HOPE_SUCCESS_CODE){
+                parse_code = hope_parse_set_fill(set, states + i, args, tokens, &ctx->arena, flags & HOPE_FLAG_LAZY, &state);
+                if(parse_code == HOPE_SUCCESS_CODE){
+                    ctx->results = state.results;
+                    ctx->nresults = state.nresults;
+                    ctx->param_results = state.param_results;
+                    ctx->used_set = i;
+                    ctx->used_set_name = set->name;
+                    return HOPE_SUCCESS_CODE;
+                }
+                // the set matched, running out of memory is no reason to try the others
+                if(parse_code == HOPE_ERR_ALLOC_FAILED_CODE){
+                    hope_report_error(flags, &ctx->error, state.error);
+                    return parse_code;
+                }
+                // the checks after the walk only see all results while filling, so their errors show up here as well
+                states[i].error = state.error;
+                rank = state.error.arg == HOPE_ERROR_NO_ARG ? SIZE_MAX - 1 : SIZE_MAX;
+            } else {
+                hope_parse_set_fail(set, states + i, parse_code);
+                rank = SIZE_MAX - 1;
+            }
+        }
+        if(!furthest || rank > furthest_rank){
+            furthest = &states[i].error;
+            furthest_rank = rank;
+        }
+    }
+    hope_report_error(flags, &ctx->error, *furthest);
+    return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+}
+
+/* The bound adds up the worst case of every allocation a parse makes: the states of all sets and the tokens,
+ * then for every set that may fail while filling, its results, value arrays and bitmask, with the strings of the values for a lazy parse,
+ * and the table, tokens and bitmask hope_parse_set and hope_parse_stream take for a single set.
+ * Every allocation may be padded to the arena alignment.
+ * Response files and hope_read_fd take memory on top, depending on their contents.
+ */
+HOPEDEF size_t hope_required_bytes(const hope_t *hope, size_t argc){
+    size_t align = HOPE_ARENA_ALIGN;
+    size_t value_size = sizeof(double) > sizeof(long int) ? sizeof(double) : sizeof(long int);
+    size_t bytes = hope_table_size(hope->sets, hope->nsets) + align + HOPE_ARENA_HEADER_SIZE + align;
+    bytes += hope->nsets * sizeof(hope_set_state_t) + (hope->nsets + 63) / 64 * sizeof(uint64_t) + 2 * align;
+    bytes += (argc + 1) * sizeof(hope_token_t) + align;
+    size_t max_single = 0;
+    for(size_t i = 0; i < hope->nsets; i++){
+        size_t nparams = hope->sets[i].nparams;
+        bytes += (argc + 1) * sizeof(hope_result_t) + (nparams + 1) * sizeof(hope_result_t*) + (nparams + 64) / 64 * sizeof(uint64_t);
+        bytes += argc * (value_size + sizeof(const char*)) + (2 * argc + 5) * align;
+        size_t single = hope_table_size(hope->sets + i, 1) + (nparams + 64) / 64 * sizeof(uint64_t) + 2 * align +
+                        (argc + 1) * sizeof(hope_token_t) + align;
+        if(single > max_single)
+            max_single = single;
+    }
+    return bytes + max_single;
+}
+
+/* Values are converted and handed to the callback during a single walk over the arguments,
+ * so nothing but the set's bitmask of passed parameters is allocated however many values there are.
+ * Counts and required parameters are validated at the end, after the values before them were streamed.
+ */
+HOPEDEF int hope_parse_stream(hope_t *hope, const char *set_name, char *args[], hope_stream_cb_t cb, void *user){
+    if(!hope->table){
+        int compile_code = hope_compile(hope);
+        if(compile_code != HOPE_SUCCESS_CODE)
+            return compile_code;
+    }
+    const hope_table_set_t *set = NULL;
+    for(size_t i = 0; i < hope->table->nsets && !set; i++){
+        if(!strcmp(hope->table->sets[i].name, set_name))
+            set = hope->table->sets + i;
+    }
+    hope->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+    if(!set){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_PARSE_ERR_NO_SET_CODE, .arg = HOPE_ERROR_NO_ARG, .value = set_name });
+        return HOPE_PARSE_ERR_NO_SET_CODE;
+    }
+    hope->arena.alloc = &hope->alloc;
+    if(hope->flags & HOPE_FLAG_RESPONSE_FILES){
+        hope_error_t error;
+        int expand_code = hope_expand_response_files(&hope->arena, &hope->mappings, args, &args, &error);
+        if(expand_code != HOPE_SUCCESS_CODE){
+            hope_report_error(hope->flags, &hope->error, error);
+            return expand_code;
+        }
+    }
+    hope_set_state_t state;
+    int parse_code = hope_parse_set_begin(set, &state, args, hope->flags);
+    state.stream = cb;
+    state.user = user;
+    state.seen = (uint64_t*) hope_arena_alloc(&hope->arena, ((set->nparams + 64) / 64) * sizeof(uint64_t));
+    if(!state.seen){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    memset(state.seen, 0, ((set->nparams + 64) / 64) * sizeof(uint64_t));
+    // the arguments are classified one at a time, a table of them would grow with the arguments
+    for(size_t i = 0; args[i] != NULL && parse_code == HOPE_SUCCESS_CODE && !state.done; i++){
+        hope_token_t token;
+        hope_classify(hope->table, args[i], &token);
+        const hope_table_param_t *param = hope_table_search_token(set, args[i], &token);
+        parse_code = hope_parse_set_step(set, &state, args + i, &token, param);
+    }
+    if(parse_code == HOPE_SUCCESS_CODE)
+        parse_code = hope_parse_set_finish(set, &state);
+    if(parse_code != HOPE_SUCCESS_CODE){
+        hope_parse_set_fail(set, &state, parse_code);
+        if(state.stopped)
+            hope->error = state.error;
+        else
+            hope_report_error(hope->flags, &hope->error, state.error);
+    }
+    return parse_code;
+}
+
+//
+// Reading values from a file descriptor
+//
+
+// Size of the chunks read from a file descriptor, a value longer than this grows the buffer
+#ifndef HOPE_READ_CHUNK
+#define HOPE_READ_CHUNK (64 * 1024)
+#endif
+
+// Read up to size bytes from fd, retrying reads interrupted by a signal
+long hope_read_chunk(int fd, char *buf, size_t size){
+    #ifdef HOPE_POSIX
+    ssize_t n;
+    do {
+        n = read(fd, buf, size);
+    } while(n < 0 && errno == EINTR);
+    return (long)n;
+    #elif defined(_WIN32)
+    return (long)_read(fd, buf, (unsigned)(size > INT_MAX ? INT_MAX : size));
+    #else
+    (void)fd;
+    (void)buf;
+    (void)size;
+    errno = ENOSYS;
+    return -1;
+    #endif
+}
+
+// Pass a value read from the input to the collector, the value is only valid until the next read.
+// cap is the amount of values the collector's array has room for.
+int hope_read_value(const hope_table_set_t *set, hope_set_state_t *state, hope_arena_t *arena, hope_result_t *result,
+                    size_t *cap, const char *str, size_t len){
+    const hope_table_param_t *collector = set->collector;
+    size_t count = state->stream ? state->collector_result.count : result->count;
+    if((collector->nargs == HOPE_ARGC_OPT && count != 0) || collector->nargs == (int)count)
+        return HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
+    if(state->stream){
+        state->collector_result.count++;
+        return hope_stream_value(set, state, str, collector);
     }
-    return NULL;
+    if(count == *cap){
+        // the array grows by doubling, the outgrown ones stay in the arena
+        size_t grown = *cap < 256 ? 256 : *cap * 2;
+        const char **values = (const char**) hope_arena_alloc(arena, grown * collector->size);
+        if(!values)
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        if(count)
+            memcpy((void*)values, (const void*)result->value.strings, count * collector->size);
+        result->value.strings = values;
+        *cap = grown;
+    }
+    if(collector->type == HOPE_TYPE_STRING){
+        // the input buffer is reused, the collector keeps a copy
+        char *copy = (char*) hope_arena_alloc(arena, len + 1);
+        if(!copy)
+            return HOPE_ERR_ALLOC_FAILED_CODE;
+        memcpy(copy, str, len + 1);
+        str = copy;
+    }
+    return collector->parse(str, result);
 }
 
-// Search for the result with the given name
-hope_result_t *hope_search_result(hope_result_t *results, size_t nresults, const char *name){
-    for(size_t i = 0; i < nresults; i++){
-        hope_result_t *cur_result =(hope_result_t*)(results + i);
-        if(name == NULL){
-            if(cur_result->name == NULL){
-                return cur_result;
+/* The input is read in large chunks and every complete value in a chunk is passed on before reading the next,
+ * so values are processed while the producer is still writing. A value split by the end of a chunk
+ * is moved to the start of the buffer and completed by the next read. Empty values are skipped.
+ */
+HOPEDEF int hope_read_fd(hope_t *hope, int fd, char delim, hope_stream_cb_t cb, void *user){
+    hope->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+    if(!hope->param_results || !hope->table){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_INVALID_STRUCT_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_INVALID_STRUCT_CODE;
+    }
+    const hope_table_set_t *set = hope->table->sets + hope->used_set;
+    if(!set->collector){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE, .arg = HOPE_ERROR_NO_ARG, .set = set->name });
+        return HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
+    }
+    // a collector that got no arguments has no result, the slot the parse kept free for it takes the values read
+    hope_result_t *result = hope->param_results[set->nparams];
+    if(!result){
+        result = hope->results + hope->nresults;
+        *result = (hope_result_t){ .type = set->collector->type };
+    }
+    // the values read are converted right away, so the ones of a lazy parse have to be as well
+    int parse_code = cb ? HOPE_SUCCESS_CODE : hope_convert_result(result, hope->flags, &hope->error);
+    if(parse_code != HOPE_SUCCESS_CODE)
+        return parse_code;
+    hope_set_state_t state = {
+        .stream = cb,
+        .user = user,
+        .collector_result.count = result->count
+    };
+    // values are numbered from the first one read, since the input is gone once it was parsed
+    size_t nread = 0;
+    size_t cap = result->count;
+    size_t size = HOPE_READ_CHUNK;
+    size_t used = 0;
+    hope->arena.alloc = &hope->alloc;
+    #ifdef HOPE_NO_MALLOC
+    // the buffer can not grow, a value that does not fit into it exhausts the capacity
+    char *buf = (char*) hope_arena_alloc(&hope->arena, size);
+    #else
+    char *buf = (char*) hope_malloc(&hope->alloc, size);
+    #endif
+    if(!buf){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
+    }
+    hope_error_t error = { .arg = HOPE_ERROR_NO_ARG };
+    bool end = false;
+    while(!end && parse_code == HOPE_SUCCESS_CODE){
+        // one byte is kept free for terminating a last value that has no delimiter
+        if(used + 1 >= size){
+            #ifdef HOPE_NO_MALLOC
+            parse_code = HOPE_ERR_CAPACITY_CODE;
+            break;
+            #else
+            char *grown = (char*) hope_realloc(&hope->alloc, buf, size, size * 2);
+            if(!grown){
+                parse_code = HOPE_ERR_ALLOC_FAILED_CODE;
+                break;
+            }
+            buf = grown;
+            size *= 2;
+            #endif
+        }
+        long n = hope_read_chunk(fd, buf + used, size - used - 1);
+        if(n < 0){
+            parse_code = HOPE_PARSE_ERR_INPUT_CODE;
+            error.value = strerror(errno);
+            break;
+        }
+        end = n == 0;
+        used += (size_t)n;
+        if(end)
+            buf[used++] = delim;
+        char *start = buf;
+        char *stop = buf + used;
+        char *found;
+        while((found = (char*) memchr(start, delim, (size_t)(stop - start)))){
+            *found = '\0';
+            if(found > start){
+                parse_code = hope_read_value(set, &state, &hope->arena, result, &cap, start, (size_t)(found - start));
+                if(parse_code != HOPE_SUCCESS_CODE){
+                    error.arg = nread;
+                    error.param = "<collector>";
+                    error.set = set->name;
+                    break;
+                }
+                nread++;
             }
-        } else if(strcmp(cur_result->name, name) == 0){
-            return cur_result;
+            start = found + 1;
         }
+        if(parse_code != HOPE_SUCCESS_CODE)
+            break;
+        used = (size_t)(stop - start);
+        memmove(buf, start, used);
     }
-    return NULL;
+    // the values themselves are gone with the buffer, only their position is kept
+    error.code = parse_code;
+    if(state.stopped)
+        hope->error = error;
+    else if(parse_code != HOPE_SUCCESS_CODE)
+        hope_report_error(hope->flags, &hope->error, error);
+    // until values arrive, the collector keeps its default
+    if(result->count > 0 && !hope->param_results[set->nparams]){
+        hope->param_results[set->nparams] = result;
+        hope->nresults++;
+    }
+    #ifndef HOPE_NO_MALLOC
+    hope_dealloc(&hope->alloc, buf, size);
+    #endif
+    return parse_code;
 }
 
-// parse an integer, allocate memory for the new item and push it to the result
-int hope_parse_integer_into_result(const char *str, hope_result_t *result){
-    char *endptr;
-    long int next_val = strtol(str, &endptr, 10);
-    if(endptr == str){
-        //hope_err_any(HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE, result->name);
-        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+// Parse the arguments with the parser, building its table first if hope_compile was not called
+HOPEDEF int hope_parse(hope_t *hope, char *args[]) {
+    if(!hope->table){
+        int compile_code = hope_compile(hope);
+        if(compile_code != HOPE_SUCCESS_CODE)
+            return compile_code;
     }
-    result->value.integers = (long int*) realloc(result->value.integers, (result->count + 1) * sizeof(long int));
-    if(!result->value.integers){
-        hope_err_any(HOPE_ERR_ALLOC_FAILED_CODE, HOPE_PARSE_ERR_GENERIC_MSG);
-        return HOPE_ERR_ALLOC_FAILED_CODE;
+    // the parser keeps the results of its last parse, it is its own context
+    hope_parse_ctx_t ctx = hope_init_parse_ctx(hope);
+    ctx.arena = hope->arena;
+    ctx.arena.alloc = &hope->alloc;
+    ctx.mappings = hope->mappings;
+    int parse_code = hope_parse_table(hope->table, &ctx, args);
+    hope->arena = ctx.arena;
+    hope->mappings = ctx.mappings;
+    hope->error = ctx.error;
+    if(parse_code == HOPE_SUCCESS_CODE){
+        hope->results = ctx.results;
+        hope->nresults = ctx.nresults;
+        hope->param_results = ctx.param_results;
+        hope->used_set = ctx.used_set;
+        hope->used_set_name = ctx.used_set_name;
     }
-    result->value.integers[result->count] = next_val;
-    result->count++;
-    return HOPE_SUCCESS_CODE;
+    return parse_code;
 }
 
-// parse a double, allocate memory for the new item and push it to the result
-int hope_parse_double_into_result(const char *str, hope_result_t *result){
-    char *endptr;
-    double next_val = strtod(str, &endptr);
-    if(endptr == str){
-        //hope_err_any(HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE, result->name);
-        return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+//
+// Shell completion
+//
+
+// Hidden argument the completion scripts run the program with, followed by the words up to the cursor
+#define HOPE_COMPLETE_ARG "__hope_complete"
+
+/* The parameter names of a set as a completion searches them, in the order strcmp sorts them
+ * params, nparams: the parameters of the set
+ * sorted: the parameters in that order, NULL if the set has them in order already
+ * ordered: whether the names can be bisected, only false if the set is out of order and there was no memory to sort it
+ */
+typedef struct {
+    const hope_param_t *params;
+    size_t nparams;
+    const hope_param_t **sorted;
+    bool ordered;
+} hope_names_t;
+
+/* Parameter names a completion has written, an open addressing set of the names keyed by their hash
+ * slots: NULL if there was no room for it, the sets before a parameter's own are then searched for its name instead
+ * cap: always a power of two
+ */
+typedef struct {
+    const char **slots;
+    size_t cap;
+} hope_written_t;
+
+// Get the parameter at the given position of the names
+const hope_param_t *hope_names_at(const hope_names_t *names, size_t i){
+    return names->sorted ? names->sorted[i] : names->params + i;
+}
+
+// Sort the parameters by name, merging runs of doubling width back and forth between the array and tmp
+void hope_sort_params(const hope_param_t **params, const hope_param_t **tmp, size_t n){
+    const hope_param_t **from = params, **to = tmp;
+    for(size_t width = 1; width < n; width *= 2){
+        for(size_t low = 0; low < n; low += 2 * width){
+            size_t mid = low + width < n ? low + width : n;
+            size_t high = mid + width < n ? mid + width : n;
+            size_t i = low, j = mid, k = low;
+            // the left run wins ties, so the sort is stable
+            while(i < mid && j < high)
+                to[k++] = strcmp(from[j]->name, from[i]->name) < 0 ? from[j++] : from[i++];
+            while(i < mid)
+                to[k++] = from[i++];
+            while(j < high)
+                to[k++] = from[j++];
+        }
+        const hope_param_t **swap = from;
+        from = to;
+        to = swap;
     }
-    result->value.doubles = (double*) realloc(result->value.doubles, (result->count + 1) * sizeof(double));
-    if(!result->value.doubles){
-        hope_err_any(HOPE_ERR_ALLOC_FAILED_CODE, HOPE_PARSE_ERR_GENERIC_MSG);
-        return HOPE_ERR_ALLOC_FAILED_CODE;
+    if(from != params)
+        memcpy(params, from, n * sizeof(*params));
+}
+
+// Put the names of the set in order, a set that has them in order already, like a static table written that way,
+// is used as it is
+void hope_names_init(hope_names_t *names, const hope_set_t *set, hope_arena_t *arena){
+    *names = (hope_names_t){ .params = set->params, .nparams = set->nparams, .ordered = true };
+    size_t i = 1;
+    while(i < set->nparams && strcmp(set->params[i - 1].name, set->params[i].name) <= 0)
+        i++;
+    if(i >= set->nparams)
+        return;
+    // the second half is only needed while sorting and stays in the arena until it is reset
+    names->sorted = (const hope_param_t**) hope_arena_alloc(arena, 2 * set->nparams * sizeof(*names->sorted));
+    names->ordered = names->sorted != NULL;
+    if(!names->sorted)
+        return;
+    for(i = 0; i < set->nparams; i++)
+        names->sorted[i] = set->params + i;
+    hope_sort_params(names->sorted, names->sorted + set->nparams, set->nparams);
+}
+
+// Get the first position whose name does not sort before the first len characters of the word, names that are out
+// of order are searched from the start
+size_t hope_names_lower(const hope_names_t *names, const char *word, size_t len){
+    if(!names->ordered)
+        return 0;
+    size_t low = 0, high = names->nparams;
+    while(low < high){
+        size_t mid = low + (high - low) / 2;
+        if(strncmp(hope_names_at(names, mid)->name, word, len) < 0)
+            low = mid + 1;
+        else
+            high = mid;
     }
-    result->value.doubles[result->count] = next_val;
-    result->count++;
-    return HOPE_SUCCESS_CODE;
+    return low;
 }
 
-// allocate memory for the new string and push it to the result
-int hope_parse_string_into_result(const char *str, hope_result_t *result){
-    result->value.strings = (const char**) realloc(result->value.strings, (result->count + 1) * sizeof(char*));
-    if(!result->value.strings){
-        return HOPE_ERR_ALLOC_FAILED_CODE;
+// Search the parameter named by the first len characters of the word, it sorts first of the names starting with them
+const hope_param_t *hope_names_find(const hope_names_t *names, const char *word, size_t len){
+    for(size_t i = hope_names_lower(names, word, len); i < names->nparams; i++){
+        const hope_param_t *param = hope_names_at(names, i);
+        int cmp = strncmp(param->name, word, len);
+        if(cmp == 0 && param->name[len] == '\0')
+            return param;
+        if(names->ordered)
+            return NULL;
     }
-    result->value.strings[result->count] = str;
-    result->count++;
-    return HOPE_SUCCESS_CODE;
+    return NULL;
 }
 
-// evaluate the required parsing method based on the parameter type, then parse and push to the result
-int hope_parse_into_result(const char *str, hope_param_t *param, hope_result_t *result){
-    switch(param->type){
-        case HOPE_TYPE_INTEGER:
-            return hope_parse_integer_into_result(str, result);
-        case HOPE_TYPE_DOUBLE: {
-            return hope_parse_double_into_result(str, result);
+// Write a name of the set at s to the sink, unless the same name was written already
+void hope_complete_name(const hope_names_t *names, size_t s, const char *name, hope_written_t *written, FILE *sink){
+    size_t len;
+    uint64_t hash = hope_hash(name, SIZE_MAX, &len);
+    if(written->slots){
+        size_t mask = written->cap - 1;
+        for(size_t i = (size_t)hash & mask;; i = (i + 1) & mask){
+            if(!written->slots[i]){
+                written->slots[i] = name;
+                break;
+            }
+            if(strcmp(written->slots[i], name) == 0)
+                return;
         }
-        case HOPE_TYPE_STRING:{
-            return hope_parse_string_into_result(str, result);
+    } else {
+        for(size_t t = 0; t < s; t++){
+            if(hope_names_find(names + t, name, len))
+                return;
         }
-        default:
-            printf("Unknown type %d\n", param->type);
-            assert(0 && "Unreachable"); // TODO: error msg for invalid type
     }
+    fwrite(name, 1, len, sink);
+    fputc('\n', sink);
 }
 
-int hope_push_parsed_result(hope_set_t *set, hope_result_t result){
-    set->results = (hope_result_t*) realloc(set->results, (set->nresults + 1) * sizeof(hope_result_t));
-    if(!set->results){ 
-        hope_err_any(HOPE_ERR_ALLOC_FAILED_CODE, HOPE_PARSE_ERR_GENERIC_MSG);
-        return HOPE_ERR_ALLOC_FAILED_CODE;
-    }   
-    set->results[set->nresults] = result;
-    set->nresults++;
-    return HOPE_SUCCESS_CODE;
+// Write the hint for a value of the type, the scripts complete file names for strings
+void hope_complete_hint(enum hope_argtype_e type, FILE *sink){
+    fputc('%', sink);
+    fputs(hope_argtype_str(type), sink);
+    fputc('\n', sink);
 }
 
-// Parse the command line arguments and store the results in the hope data structure
-HOPEDEF int hope_parse_set(hope_set_t *set, char *args[]){
-    // look for the collector first
-    hope_result_t result = {0};
-    int parse_code = 0;
-    char *error_msg = "";
-    hope_result_t collector_result = {0};
-    hope_param_t *param = NULL;
-
-    if(args[0] == NULL){
-        if(set->nparams > 0) {
-            // check if there are any required parameters
-            for(size_t i = 0; i < set->nparams; i++){
-                hope_param_t *cur_param = set->params + i;
-                if(cur_param->nargs >= HOPE_ARGC_MORE && cur_param){
-                    parse_code = HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
-                    goto defer;
-                }
-            }
-        } else if(set->collector){
-            if(set->collector->nargs >= HOPE_ARGC_MORE && set->collector->nargs != 0){ 
-                parse_code = HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
-                goto defer;
-            }
-        } 
+/* The arguments before the word decide whether it is a value: the last parameter named before it may still
+ * take values, which are hinted by their type as "%type". Otherwise the word completes to the parameter names
+ * of all sets starting with it. Names several sets share are written once. A word that is no name may also be a
+ * value of a collector. The sets are not compiled: a completion only bisects the names of every set in order,
+ * which are sorted first if a set does not have them in order.
+ */
+HOPEDEF int hope_complete(hope_t *hope, char *args[], const char *word, FILE *sink){
+    hope->arena.alloc = &hope->alloc;
+    #ifdef HOPE_NO_MALLOC
+    // before the table is built the arena may take all of the buffer, compiling places it after the table again
+    if(!hope->table && !hope->arena.head)
+        hope_arena_use_buffer(&hope->arena, hope->buffer, hope->buffer_size);
+    #endif
+    hope_names_t *names = (hope_names_t*) hope_arena_alloc(&hope->arena, hope->nsets * sizeof(*names));
+    if(!names && hope->nsets > 0){
+        hope_report_error(hope->flags, &hope->error, (hope_error_t){ .code = HOPE_ERR_ALLOC_FAILED_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_ALLOC_FAILED_CODE;
     }
- 
+    size_t nparams = 0;
+    for(size_t s = 0; s < hope->nsets; s++){
+        hope_names_init(names + s, hope->sets + s, &hope->arena);
+        nparams += hope->sets[s].nparams;
+    }
+    const hope_param_t *param = NULL;
+    size_t count = 0;
     for(size_t i = 0; args[i] != NULL; i++){
-        if(strcmp(args[i], "--") == 0)
-            continue; // skip the -- separator
-        param = hope_search_param(set, args[i]);
-        if(param){
-            result.name = param->name;
-            result.type = param->type;
-            if(param->type == HOPE_TYPE_SWITCH){
-                result.value._switch = 1;
-            } else if(param->nargs == HOPE_ARGC_NONE){
-                continue;
-            } else {
-                while(args[i+1] != NULL){
-                    if(hope_search_param(set, args[i+1]) || strcmp(args[i+1], "--") == 0)
-                        break;
-
-                    parse_code = hope_parse_into_result(args[i+1], param, &result);
-                    if(parse_code != HOPE_SUCCESS_CODE){
-                        error_msg = (char*)param->name;
-                        goto defer;
-                    }
-                    i++;
-                    if(param->nargs == HOPE_ARGC_OPT || param->nargs == (int)result.count)
-                        break;
-                }
-            }
-            hope_push_parsed_result(set, result);
-            result = (hope_result_t){0};
-        } else {
-            if (set->collector){
-                if((set->collector->nargs == HOPE_ARGC_OPT && collector_result.count != 0) ||
-                    set->collector->nargs == (int)collector_result.count){
-                    break;
-                }
-                parse_code = hope_parse_into_result(args[i], set->collector, &collector_result);
-                if(parse_code != HOPE_SUCCESS_CODE){
-                    error_msg = "<collector>";
-                    goto defer;
-                }
-            } else {
-                parse_code = HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE;
-                error_msg = "Too many arguments without a defined collector";
-                goto defer;
-            }
+        const hope_param_t *named = NULL;
+        size_t len = strlen(args[i]);
+        for(size_t s = 0; s < hope->nsets && !named; s++)
+            named = hope_names_find(names + s, args[i], len);
+        if(named){
+            param = named->type == HOPE_TYPE_SWITCH || named->nargs == HOPE_ARGC_NONE ? NULL : named;
+            count = 0;
+        } else if(param){
+            count++;
+            if(hope_is_separator(args[i]) ||
+               (param->nargs == HOPE_ARGC_OPT && count == 1) || (param->nargs > 0 && count == (size_t)param->nargs))
+                param = NULL;
         }
-        if(args[i] == NULL) 
-            break;
     }
-    // add empty entries for optional params, or error out if not enough arguments were provided earlier
-    for(size_t i = 0; i < set->nparams; i++){
-        param = set->params + i;
-        hope_result_t *param_result = hope_search_result(set->results, set->nresults, param->name);
-        if(param->nargs == HOPE_ARGC_MORE || param->nargs > HOPE_ARGC_NONE){
-            if(param_result == NULL){
-                error_msg = (char*)param->name;
-                parse_code = HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE;
-                goto defer;
+    // with HOPE_FLAG_EQUALS, the value after --name= belongs to the parameter it names
+    const char *eq = (hope->flags & HOPE_FLAG_EQUALS) && hope_is_long_name(word) ? strchr(word + 2, '=') : NULL;
+    if(eq){
+        for(size_t s = 0; s < hope->nsets; s++){
+            const hope_param_t *named = hope_names_find(names + s, word, (size_t)(eq - word));
+            if(named && named->type != HOPE_TYPE_SWITCH){
+                hope_complete_hint(named->type, sink);
+                break;
             }
-        } else if((param->nargs == HOPE_ARGC_OPTMORE || 
-                   param->nargs == HOPE_ARGC_OPT || 
-                   param->nargs == HOPE_ARGC_NONE) && 
-                  param_result == NULL){
-            result = (hope_result_t){
-                .name = param->name, 
-                .type = param->type,
-                .count = 0,
-                .value = {0}
-            };
-            hope_push_parsed_result(set, result);
         }
+        return HOPE_SUCCESS_CODE;
     }
-    if(set->collector){
-        collector_result.type = set->collector->type;
-        if ((set->collector->nargs == HOPE_ARGC_MORE && collector_result.count <= 0) ||
-            (set->collector->nargs > HOPE_ARGC_NONE && set->collector->nargs != (int)collector_result.count)){
-            error_msg = (char*)set->collector->name;
-            parse_code = HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE;
-            goto defer;
+    if(param)
+        hope_complete_hint(param->type, sink);
+    // a parameter still missing values takes the word whatever it is
+    if(param && (param->nargs > 0 || (param->nargs == HOPE_ARGC_MORE && count == 0)))
+        return HOPE_SUCCESS_CODE;
+    // names of a single set are unique, otherwise the names written are tracked in the arena
+    hope_written_t written = {0};
+    if(hope->nsets > 1){
+        written.cap = hope_table_index_cap(nparams);
+        written.slots = (const char**) hope_arena_alloc(&hope->arena, written.cap * sizeof(*written.slots));
+        if(written.slots)
+            memset(written.slots, 0, written.cap * sizeof(*written.slots));
+    }
+    size_t len = strlen(word);
+    for(size_t s = 0; s < hope->nsets; s++){
+        for(size_t i = hope_names_lower(names + s, word, len); i < names[s].nparams; i++){
+            const hope_param_t *candidate = hope_names_at(names + s, i);
+            if(strncmp(candidate->name, word, len) == 0)
+                hope_complete_name(names, s, candidate->name, &written, sink);
+            else if(names[s].ordered)
+                break;
+        }
+    }
+    if(!param && word[0] != '-'){
+        unsigned hinted = 0;
+        for(size_t s = 0; s < hope->nsets; s++){
+            const hope_param_t *collector = hope->sets[s].collector;
+            if(collector && !(hinted & (1u << collector->type))){
+                hinted |= 1u << collector->type;
+                hope_complete_hint(collector->type, sink);
+            }
         }
-        hope_push_parsed_result(set, collector_result);
     }
     return HOPE_SUCCESS_CODE;
-defer:
-    #ifdef HOPE_DEBUG
-    hope_err_any(parse_code, error_msg);
-    #else
-    (void)error_msg;
-    #endif
-    // deallocate the results, if they were allocated.
-    if(set->results) free(set->results);
-    set->results = NULL;
-    return parse_code;
 }
 
-HOPEDEF int hope_parse(hope_t *hope, char *args[]) {
-    for(size_t i = 0; i < hope->nsets; i++){
-        hope_set_t *set = (hope_set_t*)(hope->sets + i);
-        int parse_result = hope_parse_set(set, args);
-        if(parse_result == HOPE_SUCCESS_CODE){
-            hope->results = set->results;
-            hope->nresults = set->nresults;
-            hope->used_set_name = set->name;
-            return HOPE_SUCCESS_CODE;
+HOPEDEF bool hope_complete_argv(hope_t *hope, char *argv[], FILE *sink){
+    if(argv[0] == NULL || argv[1] == NULL || strcmp(argv[1], HOPE_COMPLETE_ARG) != 0)
+        return false;
+    char **args = argv + 2;
+    size_t nargs = 0;
+    while(args[nargs] != NULL)
+        nargs++;
+    if(nargs == 0){
+        hope_complete(hope, args, "", sink);
+        return true;
+    }
+    // the word at the cursor is cut off the arguments before it for the call
+    char *word = args[nargs - 1];
+    args[nargs - 1] = NULL;
+    hope_complete(hope, args, word, sink);
+    args[nargs - 1] = word;
+    return true;
+}
+
+// Write the script template to the sink, \1 stands for the command and \2 for the name of the completion function
+void hope_write_script(const char *tmpl, const char *cmd, FILE *sink){
+    for(const char *c = tmpl; *c; c++){
+        if(*c == '\1'){
+            fputs(cmd, sink);
+        } else if(*c == '\2'){
+            fputs("_hope_complete_", sink);
+            for(const char *k = cmd; *k; k++)
+                fputc(isalnum((unsigned char)*k) ? *k : '_', sink);
+        } else {
+            fputc(*c, sink);
         }
     }
-    hope_parse_err("No matching set found for the given parameters");
-    return HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
 }
 
-HOPEDEF int hope_get_switch(hope_t *hope, const char *name, bool *dest){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
-    if(!result){
-        hope_get_err_noexist(name);
-		dest = NULL;
-		return -1;
-    }
-    if(result->type != HOPE_TYPE_SWITCH){
-        hope_err_any(HOPE_GET_ERR_TYPE_MISMATCH_CODE,
-            name,
-            " was expected to be of type ",
-            hope_argtype_str(HOPE_TYPE_SWITCH),
-            ", but is of type ",
-            hope_argtype_str(result->type)
-        );
-		dest = NULL;
-		return -1;
+HOPEDEF int hope_print_completion_script(const hope_t *hope, const char *shell, FILE *sink){
+    static const char bash[] =
+        "\2() {\n"
+        "    local c\n"
+        "    local -a candidates files\n"
+        "    COMPREPLY=()\n"
+        "    # one candidate per line, read into an array so they are neither split nor globbed\n"
+        "    mapfile -t candidates < <(\"${COMP_WORDS[0]}\" " HOPE_COMPLETE_ARG " \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>/dev/null)\n"
+        "    for c in \"${candidates[@]}\"; do\n"
+        "        case \"$c\" in\n"
+        "            %string)\n"
+        "                mapfile -t files < <(compgen -f -- \"${COMP_WORDS[COMP_CWORD]}\")\n"
+        "                COMPREPLY+=(\"${files[@]}\");;\n"
+        "            %*) ;;\n"
+        "            *) COMPREPLY+=(\"$c\");;\n"
+        "        esac\n"
+        "    done\n"
+        "}\n"
+        "complete -F \2 \1\n";
+    static const char zsh[] =
+        "#compdef \1\n"
+        "\2() {\n"
+        "    local c\n"
+        "    local -a names\n"
+        "    for c in \"${(@f)$(\"${words[1]}\" " HOPE_COMPLETE_ARG " \"${(@)words[2,CURRENT]}\" 2>/dev/null)}\"; do\n"
+        "        case \"$c\" in\n"
+        "            %string) _files;;\n"
+        "            %*) _message \"${c#%}\";;\n"
+        "            ?*) names+=(\"$c\");;\n"
+        "        esac\n"
+        "    done\n"
+        "    (( ${#names} )) && compadd -- \"${names[@]}\"\n"
+        "}\n"
+        "compdef \2 \1\n";
+    static const char fish[] =
+        "function \2\n"
+        "    set -l words (commandline -opc) (commandline -ct)\n"
+        "    for c in ($words[1] " HOPE_COMPLETE_ARG " $words[2..-1] 2>/dev/null)\n"
+        "        switch $c\n"
+        "            case '%string'\n"
+        "                __fish_complete_path (commandline -ct)\n"
+        "            case '%*'\n"
+        "            case '*'\n"
+        "                echo $c\n"
+        "        end\n"
+        "    end\n"
+        "end\n"
+        "complete -c \1 -f -a '(\2)'\n";
+    const char *tmpl = !strcmp(shell, "bash") ? bash : !strcmp(shell, "zsh") ? zsh : !strcmp(shell, "fish") ? fish : NULL;
+    if(!tmpl)
+        return HOPE_ERR_UNKNOWN_SHELL_CODE;
+    // scripts are registered for the command as it is typed, without the directory it was run from
+    const char *cmd = strrchr(hope->prog_name, '/') ? strrchr(hope->prog_name, '/') + 1 : hope->prog_name;
+    hope_write_script(tmpl, cmd, sink);
+    return HOPE_SUCCESS_CODE;
+}
+
+//
+// hope_parse_ctx_t functions
+//
+
+HOPEDEF hope_parse_ctx_t hope_init_parse_ctx(const hope_t *hope){
+    return (hope_parse_ctx_t) {
+        .hope = hope,
+        .results = NULL,
+        .nresults = 0,
+        .param_results = NULL,
+        .used_set = 0,
+        .used_set_name = NULL,
+        .arena = {0},
+        .mappings = NULL,
+        .alloc = { .ctx = hope->alloc.ctx }
+    };
+}
+
+#ifdef HOPE_NO_MALLOC
+HOPEDEF void hope_set_ctx_buffer(hope_parse_ctx_t *ctx, void *buf, size_t size){
+    hope_arena_use_buffer(&ctx->arena, buf, size);
+    ctx->results = NULL;
+    ctx->nresults = 0;
+    ctx->param_results = NULL;
+}
+#endif
+
+HOPEDEF void hope_free_parse_ctx(hope_parse_ctx_t *ctx){
+    ctx->arena.alloc = &ctx->alloc;
+    hope_unmap_response_files(&ctx->alloc, &ctx->mappings);
+    hope_arena_free(&ctx->arena);
+    ctx->results = NULL;
+    ctx->nresults = 0;
+    ctx->param_results = NULL;
+}
+
+HOPEDEF void hope_reset_parse_ctx(hope_parse_ctx_t *ctx){
+    ctx->arena.alloc = &ctx->alloc;
+    hope_unmap_response_files(&ctx->alloc, &ctx->mappings);
+    hope_arena_reset(&ctx->arena);
+    ctx->results = NULL;
+    ctx->nresults = 0;
+    ctx->param_results = NULL;
+    ctx->used_set = 0;
+    ctx->used_set_name = NULL;
+    ctx->error = (hope_error_t){ .arg = HOPE_ERROR_NO_ARG };
+}
+
+// Parse the arguments into the context. The table is not built here,
+// since that would write to the parser other contexts may be reading.
+HOPEDEF int hope_parse_ctx(hope_parse_ctx_t *ctx, char *args[]){
+    if(!ctx->hope->table){
+        // the parser has to be compiled before parsing into a context
+        hope_report_error(ctx->hope->flags, &ctx->error, (hope_error_t){ .code = HOPE_ERR_INVALID_STRUCT_CODE, .arg = HOPE_ERROR_NO_ARG });
+        return HOPE_ERR_INVALID_STRUCT_CODE;
     }
-    *dest = result->value._switch;
-    return 1;
+    // contexts are passed around by value, so the arena is pointed at the allocator here
+    ctx->arena.alloc = &ctx->alloc;
+    return hope_parse_table(ctx->hope->table, ctx, args);
 }
 
-HOPEDEF inline int hope_parse_argv(hope_t *hope, char *argv[]) {
-    return hope_parse(hope, argv + 1);
+// Get the results of the last parse of the parser as a context
+hope_parse_ctx_t hope_ctx_of(const hope_t *hope){
+    return (hope_parse_ctx_t) {
+        .hope = hope,
+        .results = hope->results,
+        .nresults = hope->nresults,
+        .param_results = hope->param_results,
+        .used_set = hope->used_set,
+        .used_set_name = hope->used_set_name,
+        .arena = hope->arena,
+        .mappings = hope->mappings
+    };
 }
 
-HOPEDEF int hope_get_integer(hope_t *hope, const char *name, long int **dest){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
+// Get the result of the parameter at the given position of the used set (nparams for the collector)
+hope_result_t *hope_param_result(const hope_parse_ctx_t *ctx, const hope_table_set_t *set, size_t index){
+    hope_result_t *result = ctx->param_results[index];
+    if(result)
+        return result;
+    // the result of an absent parameter is never written to, its values are already converted
+    return (hope_result_t*) &set->params[index].absent;
+}
+
+// Find the result of the parameter with the given name in the used set
+hope_result_t *hope_find_result(const hope_parse_ctx_t *ctx, const char *name){
+    if(!ctx->param_results || !ctx->hope->table)
+        return NULL;
+    const hope_table_set_t *set = ctx->hope->table->sets + ctx->used_set;
+    if(name == NULL)
+        return set->collector ? hope_param_result(ctx, set, set->nparams) : NULL;
+    const hope_table_param_t *param = hope_table_search(set, name);
+    return param ? hope_param_result(ctx, set, (size_t)(param - set->params)) : NULL;
+}
+
+// Find the result of the parameter behind the handle in the used set
+hope_result_t *hope_find_result_by_handle(const hope_parse_ctx_t *ctx, hope_handle_t handle){
+    if(!ctx->param_results || !ctx->hope->table || handle.set != ctx->used_set_name)
+        return NULL;
+    const hope_table_set_t *set = ctx->hope->table->sets + ctx->used_set;
+    if(handle.index == HOPE_HANDLE_COLLECTOR)
+        return set->collector ? hope_param_result(ctx, set, set->nparams) : NULL;
+    return handle.index < set->nparams ? hope_param_result(ctx, set, handle.index) : NULL;
+}
+
+// Check that the result exists and has the expected type, otherwise store the error and print it unless quiet
+bool hope_check_result(hope_result_t *result, const char *name, enum hope_argtype_e type, unsigned flags, hope_error_t *error){
+    if(!name)
+        name = "<collector>";
     if(!result){
-        hope_get_err_noexist(name);
-        dest = NULL;
-		return -1;
-    }
-    if(result->type != HOPE_TYPE_INTEGER){
-        hope_err_any(HOPE_GET_ERR_TYPE_MISMATCH_CODE,
-            name,
-            " was expected to be of type ",
-            hope_argtype_str(HOPE_TYPE_INTEGER),
-            ", but is of type ",
-            hope_argtype_str(result->type)
-        );
-        dest = NULL;
-		return -1;
+        *error = (hope_error_t){ .code = HOPE_GET_ERR_NOEXIST_CODE, .arg = HOPE_ERROR_NO_ARG, .param = name };
+        if(!(flags & HOPE_FLAG_QUIET))
+            hope_get_err_noexist(name);
+        return false;
+    }
+    if(result->type != type){
+        // the value of the error names the type the parameter really has
+        *error = (hope_error_t){ .code = HOPE_GET_ERR_TYPE_MISMATCH_CODE, .arg = HOPE_ERROR_NO_ARG, .param = name,
+                                 .value = hope_argtype_str(result->type) };
+        if(!(flags & HOPE_FLAG_QUIET))
+            hope_err_any(HOPE_GET_ERR_TYPE_MISMATCH_CODE,
+                name,
+                " was expected to be of type ",
+                hope_argtype_str(type),
+                ", but is of type ",
+                hope_argtype_str(result->type)
+            );
+        return false;
+    }
+    // the values of a lazy parse are converted by the first getter that reads them
+    return hope_convert_result(result, flags, error) == HOPE_SUCCESS_CODE;
+}
+
+int hope_get_switch_result(hope_result_t *result, const char *name, bool *dest, unsigned flags, hope_error_t *error){
+    if(!hope_check_result(result, name, HOPE_TYPE_SWITCH, flags, error)){
+        *dest = false;
+        return -1;
+    }
+    *dest = result->value._switch;
+    return 1;
+}
+
+int hope_get_integer_result(hope_result_t *result, const char *name, long int **dest, unsigned flags, hope_error_t *error){
+    if(!hope_check_result(result, name, HOPE_TYPE_INTEGER, flags, error)){
+        *dest = NULL;
+        return -1;
     }
     *dest = result->value.integers;
     return result->count;
 }
 
-HOPEDEF int hope_get_double(hope_t *hope, const char *name, double **dest){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
-    if(!result){
-        hope_get_err_noexist(name);
-        dest = NULL;
-		return -1;
-    }
-    if(result->type != HOPE_TYPE_DOUBLE){
-        hope_err_any(HOPE_GET_ERR_TYPE_MISMATCH_CODE,
-            name,
-            " was expected to be of type ",
-            hope_argtype_str(HOPE_TYPE_DOUBLE),
-            ", but is of type ",
-            hope_argtype_str(result->type)
-        );
-        dest = NULL;
-		return -1;
+int hope_get_double_result(hope_result_t *result, const char *name, double **dest, unsigned flags, hope_error_t *error){
+    if(!hope_check_result(result, name, HOPE_TYPE_DOUBLE, flags, error)){
+        *dest = NULL;
+        return -1;
     }
     *dest = result->value.doubles;
     return result->count;
 }
 
-HOPEDEF int hope_get_string(hope_t *hope, const char *name, const char ***dest){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
-    if(!result){
-        hope_get_err_noexist(name);
-        dest = NULL;
-		return -1;
-    }
-    if(result->type != HOPE_TYPE_STRING){
-        hope_err_any(HOPE_GET_ERR_TYPE_MISMATCH_CODE,
-            name,
-            " was expected to be of type ",
-            hope_argtype_str(HOPE_TYPE_STRING),
-            ", but is of type ",
-            hope_argtype_str(result->type)
-        );
-        dest = NULL;
-		return -1;
+int hope_get_string_result(hope_result_t *result, const char *name, const char ***dest, unsigned flags, hope_error_t *error){
+    if(!hope_check_result(result, name, HOPE_TYPE_STRING, flags, error)){
+        *dest = NULL;
+        return -1;
     }
     *dest = result->value.strings;
     return result->count;
 }
 
-// Get a single switch or return false if it wasn't set.
-HOPEDEF bool hope_get_single_switch(hope_t *hope, const char *name){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
+HOPEDEF int hope_get_switch(hope_t *hope, const char *name, bool *dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_switch_result(hope_find_result(&ctx, name), name, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF inline int hope_parse_argv(hope_t *hope, char *argv[]) {
+    return hope_parse(hope, argv + 1);
+}
+
+HOPEDEF int hope_get_integer(hope_t *hope, const char *name, long int **dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_integer_result(hope_find_result(&ctx, name), name, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_double(hope_t *hope, const char *name, double **dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_double_result(hope_find_result(&ctx, name), name, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_string(hope_t *hope, const char *name, const char ***dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_string_result(hope_find_result(&ctx, name), name, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_switch_by_handle(hope_t *hope, hope_handle_t handle, bool *dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    hope_result_t *result = hope_find_result_by_handle(&ctx, handle);
+    return hope_get_switch_result(result, result ? result->name : handle.set, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_integer_by_handle(hope_t *hope, hope_handle_t handle, long int **dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    hope_result_t *result = hope_find_result_by_handle(&ctx, handle);
+    return hope_get_integer_result(result, result ? result->name : handle.set, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_double_by_handle(hope_t *hope, hope_handle_t handle, double **dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    hope_result_t *result = hope_find_result_by_handle(&ctx, handle);
+    return hope_get_double_result(result, result ? result->name : handle.set, dest, hope->flags, &hope->error);
+}
+
+HOPEDEF int hope_get_string_by_handle(hope_t *hope, hope_handle_t handle, const char ***dest){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    hope_result_t *result = hope_find_result_by_handle(&ctx, handle);
+    return hope_get_string_result(result, result ? result->name : handle.set, dest, hope->flags, &hope->error);
+}
+
+bool hope_get_single_switch_result(hope_result_t *result){
     assert(result && "Queried parameter could not be found.");
     assert(result->type == HOPE_TYPE_SWITCH && "Queried parameter is not of switch type");
     assert(result->count < 2 && "Queried parameter contained more than 1 value.");
     return result->value._switch;
 }
 
-// Get a single integer or return a default value if none were passed.
-HOPEDEF long int hope_get_single_integer(hope_t *hope, const char *name){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
+long int hope_get_single_integer_result(hope_result_t *result, unsigned flags, hope_error_t *error){
     assert(result && "Queried parameter could not be found.");
     assert(result->type == HOPE_TYPE_INTEGER && "Queried parameter is not of integer type");
     assert(result->count < 2 && "Queried parameter contained more than 1 value.");
+    // a value of a lazy parse that is no number is reported like a failed parse instead of aborting
+    if(hope_convert_result(result, flags, error) != HOPE_SUCCESS_CODE)
+        return 0;
     return result->count ? result->value.integers[0] : 0;
 }
 
-// Get a single double or return a default value if none were passed.
-HOPEDEF double hope_get_single_double(hope_t *hope, const char *name){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
+double hope_get_single_double_result(hope_result_t *result, unsigned flags, hope_error_t *error){
     assert(result && "Queried parameter could not be found.");
     assert(result->type == HOPE_TYPE_DOUBLE && "Queried parameter is not of double type");
     assert(result->count < 2 && "Queried parameter contained more than 1 value.");
+    // a value of a lazy parse that is no number is reported like a failed parse instead of aborting
+    if(hope_convert_result(result, flags, error) != HOPE_SUCCESS_CODE)
+        return 0.0;
     return result->count ? result->value.doubles[0] : 0.0;
 }
 
-// Get a single string or return a default value if none were passed.
-HOPEDEF const char *hope_get_single_string(hope_t *hope, const char *name){
-    hope_result_t *result = hope_search_result(hope->results, hope->nresults, name);
+const char *hope_get_single_string_result(hope_result_t *result){
     assert(result && "Queried parameter could not be found.");
     assert(result->type == HOPE_TYPE_STRING && "Queried parameter is not of string type");
     assert(result->count < 2 && "Queried parameter contained more than 1 value.");
     return result->count ? result->value.strings[0] : NULL;
 }
+
+// Get a single switch or return false if it wasn't set.
+HOPEDEF bool hope_get_single_switch(hope_t *hope, const char *name){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_switch_result(hope_find_result(&ctx, name));
+}
+
+// Get a single integer or return a default value if none were passed.
+HOPEDEF long int hope_get_single_integer(hope_t *hope, const char *name){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_integer_result(hope_find_result(&ctx, name), hope->flags, &hope->error);
+}
+
+// Get a single double or return a default value if none were passed.
+HOPEDEF double hope_get_single_double(hope_t *hope, const char *name){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_double_result(hope_find_result(&ctx, name), hope->flags, &hope->error);
+}
+
+// Get a single string or return a default value if none were passed.
+HOPEDEF const char *hope_get_single_string(hope_t *hope, const char *name){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_string_result(hope_find_result(&ctx, name));
+}
+
+HOPEDEF bool hope_get_single_switch_by_handle(hope_t *hope, hope_handle_t handle){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_switch_result(hope_find_result_by_handle(&ctx, handle));
+}
+
+HOPEDEF long int hope_get_single_integer_by_handle(hope_t *hope, hope_handle_t handle){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_integer_result(hope_find_result_by_handle(&ctx, handle), hope->flags, &hope->error);
+}
+
+HOPEDEF double hope_get_single_double_by_handle(hope_t *hope, hope_handle_t handle){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_double_result(hope_find_result_by_handle(&ctx, handle), hope->flags, &hope->error);
+}
+
+HOPEDEF const char *hope_get_single_string_by_handle(hope_t *hope, hope_handle_t handle){
+    hope_parse_ctx_t ctx = hope_ctx_of(hope);
+    return hope_get_single_string_result(hope_find_result_by_handle(&ctx, handle));
+}
+
+//
+// hope_parse_ctx_t getters
+//
+
+HOPEDEF int hope_ctx_get_switch(hope_parse_ctx_t *ctx, const char *name, bool *dest){
+    return hope_get_switch_result(hope_find_result(ctx, name), name, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_integer(hope_parse_ctx_t *ctx, const char *name, long int **dest){
+    return hope_get_integer_result(hope_find_result(ctx, name), name, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_double(hope_parse_ctx_t *ctx, const char *name, double **dest){
+    return hope_get_double_result(hope_find_result(ctx, name), name, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_string(hope_parse_ctx_t *ctx, const char *name, const char ***dest){
+    return hope_get_string_result(hope_find_result(ctx, name), name, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_switch_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, bool *dest){
+    hope_result_t *result = hope_find_result_by_handle(ctx, handle);
+    return hope_get_switch_result(result, result ? result->name : handle.set, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_integer_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, long int **dest){
+    hope_result_t *result = hope_find_result_by_handle(ctx, handle);
+    return hope_get_integer_result(result, result ? result->name : handle.set, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_double_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, double **dest){
+    hope_result_t *result = hope_find_result_by_handle(ctx, handle);
+    return hope_get_double_result(result, result ? result->name : handle.set, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF int hope_ctx_get_string_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle, const char ***dest){
+    hope_result_t *result = hope_find_result_by_handle(ctx, handle);
+    return hope_get_string_result(result, result ? result->name : handle.set, dest, ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF bool hope_ctx_get_single_switch(hope_parse_ctx_t *ctx, const char *name){
+    return hope_get_single_switch_result(hope_find_result(ctx, name));
+}
+
+HOPEDEF long int hope_ctx_get_single_integer(hope_parse_ctx_t *ctx, const char *name){
+    return hope_get_single_integer_result(hope_find_result(ctx, name), ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF double hope_ctx_get_single_double(hope_parse_ctx_t *ctx, const char *name){
+    return hope_get_single_double_result(hope_find_result(ctx, name), ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF const char *hope_ctx_get_single_string(hope_parse_ctx_t *ctx, const char *name){
+    return hope_get_single_string_result(hope_find_result(ctx, name));
+}
+
+HOPEDEF bool hope_ctx_get_single_switch_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle){
+    return hope_get_single_switch_result(hope_find_result_by_handle(ctx, handle));
+}
+
+HOPEDEF long int hope_ctx_get_single_integer_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle){
+    return hope_get_single_integer_result(hope_find_result_by_handle(ctx, handle), ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF double hope_ctx_get_single_double_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle){
+    return hope_get_single_double_result(hope_find_result_by_handle(ctx, handle), ctx->hope->flags, &ctx->error);
+}
+
+HOPEDEF const char *hope_ctx_get_single_string_by_handle(hope_parse_ctx_t *ctx, hope_handle_t handle){
+    return hope_get_single_string_result(hope_find_result_by_handle(ctx, handle));
+}
 #endif // HOPE_IMPLEMENTATION
 #endif // HOPE_H_
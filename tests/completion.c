@@ -0,0 +1,175 @@
+// Shell completion: the candidates written for names, short and empty words and values, names shared by sets written
+// once, --name= values and the scripts for every shell. The program is its own completed command, so the bash script
+// is also run against it.
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static int failures = 0;
+
+// The names are added out of order, the -v of the list set is the same name as the one of the build set
+static hope_t init_parser(const char *prog_name){
+    hope_t hope = hope_init(prog_name, NULL);
+    hope.flags |= HOPE_FLAG_EQUALS | HOPE_FLAG_QUIET;
+    hope_set_t build = hope_init_set("build");
+    hope_add_param(&build, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param("-xyz", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param("-o", NULL, HOPE_TYPE_STRING, 1));
+    hope_add_param(&build, hope_init_param("--verbose", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param("-j", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param("--jobs", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param("-x", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&build, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, build);
+    static const hope_param_t list[] = {
+        HOPE_PARAM("--level", NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_OPT),
+        HOPE_PARAM("--list", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE),
+        HOPE_PARAM("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT),
+    };
+    hope_add_set(&hope, HOPE_INIT_STATIC_SET("list", list));
+    return hope;
+}
+
+// Complete the word after the arguments and compare what was written
+static void check(const char *what, char *args[], const char *word, const char *expected){
+    hope_t hope = init_parser("completion");
+    char *out = NULL;
+    size_t size = 0;
+    FILE *sink = open_memstream(&out, &size);
+    int code = hope_complete(&hope, args, word, sink);
+    fclose(sink);
+    if(code != HOPE_SUCCESS_CODE || strcmp(out, expected) != 0){
+        printf("completion: %s gave %x and\n%s", what, code, out);
+        failures++;
+    }
+    free(out);
+    hope_free(&hope);
+}
+
+// Print the script for the shell and check the lines it has to register the command with
+static void check_script(const char *shell, const char *lines[], size_t nlines){
+    hope_t hope = init_parser("/usr/local/bin/my-tool");
+    char *out = NULL;
+    size_t size = 0;
+    FILE *sink = open_memstream(&out, &size);
+    int code = hope_print_completion_script(&hope, shell, sink);
+    fclose(sink);
+    if(code != HOPE_SUCCESS_CODE || !strstr(out, HOPE_COMPLETE_ARG))
+        failures++;
+    for(size_t i = 0; i < nlines; i++){
+        if(!strstr(out, lines[i])){
+            printf("completion: the %s script lacks \"%s\"\n", shell, lines[i]);
+            failures++;
+        }
+    }
+    free(out);
+    hope_free(&hope);
+}
+
+// Source the bash script of this program, complete the word with it and compare the candidates
+static void check_bash(const char *self, const char *word, const char *expected){
+    hope_t hope = init_parser(self);
+    char path[] = "/tmp/hope_completion_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *script = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if(!script || hope_print_completion_script(&hope, "bash", script) != HOPE_SUCCESS_CODE){
+        failures++;
+        hope_free(&hope);
+        return;
+    }
+    fclose(script);
+    hope_free(&hope);
+    // the function is named after the command like the script names it
+    char function[256] = "_hope_complete_";
+    const char *cmd = strrchr(self, '/') ? strrchr(self, '/') + 1 : self;
+    for(size_t i = strlen(function); *cmd && i < sizeof(function) - 1; cmd++, i++)
+        function[i] = isalnum((unsigned char)*cmd) ? *cmd : '_';
+    char command[1024];
+    snprintf(command, sizeof(command),
+             "bash -c 'source \"$1\"; COMP_WORDS=(\"$2\" \"$3\"); COMP_CWORD=1; %s; "
+             "printf \"%%s\\n\" \"${COMPREPLY[@]}\"' _ '%s' '%s' '%s'", function, path, self, word);
+    FILE *pipe = popen(command, "r");
+    char out[256] = "";
+    size_t len = pipe ? fread(out, 1, sizeof(out) - 1, pipe) : 0;
+    out[len] = '\0';
+    if(!pipe || pclose(pipe) != 0 || strcmp(out, expected) != 0){
+        printf("completion: bash completed \"%s\" to\n%s", word, out);
+        failures++;
+    }
+    remove(path);
+}
+
+int main(int argc, char *argv[]){
+    (void)argc;
+    // run by the script, the program answers like any program using hope does
+    hope_t self = init_parser(argv[0]);
+    if(hope_complete_argv(&self, argv, stdout)){
+        hope_free(&self);
+        return 0;
+    }
+    hope_free(&self);
+
+    char *none[] = {NULL};
+    check("an empty word", none, "",
+          "--jobs\n--verbose\n-j\n-o\n-v\n-x\n-xyz\n--level\n--list\n%string\n");
+    check("a dash", none, "-", "--jobs\n--verbose\n-j\n-o\n-v\n-x\n-xyz\n--level\n--list\n");
+    check("a short name", none, "-x", "-x\n-xyz\n");
+    check("a name shared by both sets", none, "-v", "-v\n");
+    check("a long prefix", none, "--l", "--level\n--list\n");
+    check("a full long name", none, "--jobs", "--jobs\n");
+    check("a word no name starts with", none, "--zzz", "");
+    check("a value", none, "file", "%string\n");
+
+    char *output[] = {"-o", NULL};
+    check("the value of -o", output, "", "%string\n");
+    char *list[] = {"--list", NULL};
+    check("the first value of --list", list, "-", "%string\n");
+    char *jobs[] = {"-j", NULL};
+    check("the optional value of -j", jobs, "-x", "%integer\n-x\n-xyz\n");
+    char *jobs_given[] = {"-j", "3", NULL};
+    check("a word after the value of -j", jobs_given, "-x", "-x\n-xyz\n");
+    char *switched[] = {"-v", NULL};
+    check("a word after a switch", switched, "--", "--jobs\n--verbose\n--level\n--list\n");
+    check("a value after =", none, "--jobs=", "%integer\n");
+    check("a switch with =", none, "--verbose=", "");
+    check("a value after = of the second set", none, "--level=0.", "%double\n");
+
+    // only the hidden argument makes the program complete, the word at the cursor is the last argument
+    char *plain[] = {"completion", "-v", NULL};
+    char *hidden[] = {"completion", HOPE_COMPLETE_ARG, "-o", NULL};
+    hope_t hope = init_parser("completion");
+    char *out = NULL;
+    size_t size = 0;
+    FILE *sink = open_memstream(&out, &size);
+    if(hope_complete_argv(&hope, plain, sink) || !hope_complete_argv(&hope, hidden, sink))
+        failures++;
+    fclose(sink);
+    if(strcmp(out, "-o\n") != 0)
+        failures++;
+    free(out);
+    hope_free(&hope);
+
+    const char *bash[] = {"_hope_complete_my_tool() {", "complete -F _hope_complete_my_tool my-tool\n"};
+    check_script("bash", bash, 2);
+    const char *zsh[] = {"#compdef my-tool\n", "compdef _hope_complete_my_tool my-tool\n"};
+    check_script("zsh", zsh, 2);
+    const char *fish[] = {"function _hope_complete_my_tool\n", "complete -c my-tool -f -a '(_hope_complete_my_tool)'\n"};
+    check_script("fish", fish, 2);
+    hope = init_parser("completion");
+    if(hope_print_completion_script(&hope, "tcsh", stdout) != HOPE_ERR_UNKNOWN_SHELL_CODE)
+        failures++;
+    hope_free(&hope);
+
+    if(system("bash -c '(( BASH_VERSINFO[0] >= 4 ))' 2>/dev/null") == 0){
+        check_bash(argv[0], "--l", "--level\n--list\n");
+        check_bash(argv[0], "-x", "-x\n-xyz\n");
+    }
+
+    printf("completion: %d failures\n", failures);
+    return failures != 0;
+}
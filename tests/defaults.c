@@ -0,0 +1,109 @@
+// The getters return the declared default of an optional parameter that was not passed, without calling the
+// allocator, and parameters that were not passed cost the parse nothing. HOPE_ALLOC_STATS counts every call to the
+// allocator of the parser and of a context.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_ALLOC_STATS
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+#define NEXTRA 100
+
+static char extra_names[NEXTRA][16];
+static int failures = 0;
+
+// Build the set, with nextra more optional integers
+static void add_main(hope_t *hope, size_t nextra){
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_param_default_integer(hope_init_param("-j", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT), 4));
+    hope_add_param(&set, hope_param_default_double(hope_init_param("-r", NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_OPT), 0.25));
+    hope_add_param(&set, hope_param_default_string(hope_init_param("-o", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPT), "a.out"));
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_param_default_string(hope_init_param("--lib", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE), "c"));
+    for(size_t i = 0; i < nextra; i++)
+        hope_add_param(&set, hope_init_param(extra_names[i], NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPTMORE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(hope, set);
+}
+
+// Check that the parse left every parameter absent and the getters read their defaults without allocating
+static void check_defaults(const char *what, hope_t *hope){
+    size_t calls = hope->alloc.calls;
+    bool verbose = true;
+    long int *jobs;
+    double *ratio;
+    const char **output, **libs;
+    if(hope_get_switch(hope, "-v", &verbose) != 1 || verbose || hope_get_single_switch(hope, "-v"))
+        failures++;
+    if(hope_get_integer(hope, "-j", &jobs) != 1 || jobs[0] != 4 || hope_get_single_integer(hope, "-j") != 4)
+        failures++;
+    if(hope_get_double(hope, "-r", &ratio) != 1 || ratio[0] != 0.25 || hope_get_single_double(hope, "-r") != 0.25)
+        failures++;
+    if(hope_get_string(hope, "-o", &output) != 1 || strcmp(output[0], "a.out") ||
+       strcmp(hope_get_single_string(hope, "-o"), "a.out"))
+        failures++;
+    if(hope_get_string(hope, "--lib", &libs) != 1 || strcmp(libs[0], "c"))
+        failures++;
+    // without a default the getters give no values and zero
+    long int *level;
+    if(hope_get_integer(hope, "-n", &level) != 0 || hope_get_single_integer(hope, "-n") != 0)
+        failures++;
+    if(hope->alloc.calls != calls){
+        printf("defaults: %s, the getters called the allocator %zu times\n", what, hope->alloc.calls - calls);
+        failures++;
+    }
+}
+
+int main(void){
+    for(int i = 0; i < NEXTRA; i++)
+        snprintf(extra_names[i], sizeof(extra_names[i]), "-x%d", i);
+
+    hope_t hope = hope_init("defaults", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    add_main(&hope, 0);
+    char *empty_args[] = {NULL};
+    char *files_args[] = {"a.c", "b.c", NULL};
+    if(hope_parse(&hope, empty_args) != HOPE_SUCCESS_CODE)
+        failures++;
+    check_defaults("no arguments", &hope);
+    if(hope_parse(&hope, files_args) != HOPE_SUCCESS_CODE)
+        failures++;
+    check_defaults("only files", &hope);
+
+    // a lazy parser converts values in the getters, a default has no value to convert
+    hope_t lazy = hope_init("defaults", NULL);
+    lazy.flags |= HOPE_FLAG_QUIET | HOPE_FLAG_LAZY;
+    add_main(&lazy, 0);
+    if(hope_parse(&lazy, files_args) != HOPE_SUCCESS_CODE)
+        failures++;
+    check_defaults("a lazy parser", &lazy);
+    hope_free(&lazy);
+
+    // absent optional parameters cost the parse nothing: a hundred more of them, not passed, take no more calls
+    hope_t extra = hope_init("defaults", NULL);
+    add_main(&extra, NEXTRA);
+    if(hope_compile(&extra) != HOPE_SUCCESS_CODE)
+        failures++;
+    hope_parse_ctx_t few = hope_init_parse_ctx(&hope), many = hope_init_parse_ctx(&extra);
+    if(hope_parse_ctx(&few, files_args) != HOPE_SUCCESS_CODE || hope_parse_ctx(&many, files_args) != HOPE_SUCCESS_CODE)
+        failures++;
+    if(many.alloc.calls != few.alloc.calls){
+        printf("defaults: %d absent parameters took %zu calls, none took %zu\n", NEXTRA, many.alloc.calls,
+               few.alloc.calls);
+        failures++;
+    }
+    hope_free_parse_ctx(&few);
+    hope_free_parse_ctx(&many);
+    hope_free(&extra);
+
+    // a passed value replaces the default
+    char *passed_args[] = {"-j", "8", "-o", "out", NULL};
+    if(hope_parse(&hope, passed_args) != HOPE_SUCCESS_CODE || hope_get_single_integer(&hope, "-j") != 8 ||
+       strcmp(hope_get_single_string(&hope, "-o"), "out") || hope_get_single_double(&hope, "-r") != 0.25)
+        failures++;
+    hope_free(&hope);
+    printf("defaults: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,129 @@
+// hope_parse_double has to give the same bits as strtod, on Clinger's fast path as well as on the fallback to strtod.
+// Every float32 bit pattern printed with %.9g has to come back as the same float, and printed with %.17g as the same
+// double. The sweep takes every 4099th pattern, pass "full" to check all of them. Every number is also converted the
+// way it is outside the "C" locale, through its digits without the decimal point, which has to give the same bits.
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static int failures = 0;
+
+// Compare the bits of the value to those strtod gave
+static void compare(const char *str, const char *how, double value, double strtod_value){
+    if(memcmp(&value, &strtod_value, sizeof(double)) != 0 && !(isnan(value) && isnan(strtod_value))){
+        if(failures++ < 10)
+            printf("double_roundtrip: '%.40s' gave %a%s, strtod %a\n", str, value, how, strtod_value);
+    }
+}
+
+// Parse the string with both and compare the bits, returns the value hope_parse_double gave
+static double check_same(const char *str){
+    double hope_value = 0, strtod_value = strtod(str, NULL);
+    if(hope_parse_double(str, &hope_value) != HOPE_SUCCESS_CODE){
+        if(failures++ < 10)
+            printf("double_roundtrip: '%s' was rejected\n", str);
+        return hope_value;
+    }
+    compare(str, "", hope_value, strtod_value);
+    if(!strpbrk(str, "nN")){
+        double digits_value = 0;
+        hope_parse_double_digits(str, &digits_value);
+        compare(str, " through its digits", digits_value, strtod_value);
+    }
+    return hope_value;
+}
+
+// xorshift64, so the values are the same on every platform
+static uint64_t next_random(void){
+    static uint64_t state = 0x9e3779b97f4a7c15u;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+int main(int argc, char *argv[]){
+    uint64_t stride = argc > 1 && !strcmp(argv[1], "full") ? 1 : 4099;
+    char buf[64];
+
+    // float32 bit patterns, which cover every binary exponent a float has, subnormals included
+    uint64_t checked = 0;
+    for(uint64_t bits = 0; bits <= UINT32_MAX; bits += stride){
+        uint32_t pattern = (uint32_t)bits;
+        float original;
+        memcpy(&original, &pattern, sizeof(float));
+        if(!isfinite(original))
+            continue;
+        snprintf(buf, sizeof(buf), "%.9g", (double)original);
+        float back = (float)check_same(buf);
+        if(memcmp(&back, &original, sizeof(float)) != 0 && failures++ < 10)
+            printf("double_roundtrip: float %a printed as '%s' came back as %a\n", (double)original, buf, (double)back);
+        snprintf(buf, sizeof(buf), "%.17g", (double)original);
+        if(check_same(buf) != (double)original && failures++ < 10)
+            printf("double_roundtrip: double %a printed as '%s' did not come back\n", (double)original, buf);
+        checked++;
+    }
+
+    // the fast path: up to 15 significant digits with a power of ten within 1e-22 to 1e22
+    for(int i = 0; i < 200000; i++){
+        uint64_t mantissa = next_random() % 1000000000000000u;
+        int exponent = (int)(next_random() % 45) - 22;
+        snprintf(buf, sizeof(buf), "%s%llue%d", i & 1 ? "-" : "", (unsigned long long)mantissa, exponent);
+        check_same(buf);
+        snprintf(buf, sizeof(buf), "%.6f", (double)mantissa / 1e6);
+        check_same(buf);
+    }
+    // the fallback: 16 to 19 digits, more digits than are kept, and powers of ten no double holds exactly
+    for(int i = 0; i < 200000; i++){
+        uint64_t random = next_random();
+        double value;
+        memcpy(&value, &random, sizeof(double));
+        if(!isfinite(value))
+            continue;
+        snprintf(buf, sizeof(buf), "%.17g", value);
+        check_same(buf);
+        snprintf(buf, sizeof(buf), "%llu%03d", (unsigned long long)(random >> 1), (int)(random % 1000));
+        check_same(buf);
+        snprintf(buf, sizeof(buf), "%llue%d", (unsigned long long)(random % 10000000000000000000u), (int)(random % 640) - 340);
+        check_same(buf);
+    }
+    static const char *edges[] = {
+        "0", "-0", "+0.0", "0e999", "1", "0.1", "9007199254740992", "9007199254740993", "9007199254740994",
+        "123456789012345", "1234567890123456", "1e22", "1e23", "1e-22", "1e-23", "4.9e-324", "2.4703282292062327e-324",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "1.7976931348623157e308", "1.7976931348623159e308",
+        "1e309", "1e-400", ".5", "5.", "00000000000000000000001.5", "0.000000000000000000000000000001",
+        "inf", "-Infinity", "nan", "NAN"
+    };
+    for(size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+        check_same(edges[i]);
+    // more digits than are kept, the tie between 1 and the next double followed by a far 1 has to round up
+    static char tie[1000], longer[1000];
+    snprintf(tie, sizeof(tie), "%s%0800d1", "1.00000000000000011102230246251565404236316680908203125", 0);
+    check_same(tie);
+    tie[strlen(tie) - 1] = '0';
+    check_same(tie);
+    memset(longer, '7', sizeof(longer) - 6);
+    strcpy(longer + sizeof(longer) - 6, "e-700");
+    check_same(longer);
+    longer[400] = '.';
+    check_same(longer);
+    // -0 keeps its sign
+    double zero = 0;
+    if(hope_parse_double("-0", &zero) != HOPE_SUCCESS_CODE || !signbit(zero))
+        failures++;
+
+    static const char *invalid[] = {"", "-", ".", "e5", "1e", "1e+", "1.2.3", " 1", "1 ", "0x1p3", "1f", "in", "nana"};
+    for(size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++){
+        double value;
+        if(hope_parse_double(invalid[i], &value) != HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE && failures++ < 10)
+            printf("double_roundtrip: '%s' was accepted\n", invalid[i]);
+    }
+
+    printf("double_roundtrip: %llu float32 patterns, %d failures\n", (unsigned long long)checked, failures);
+    return failures != 0;
+}
@@ -0,0 +1,159 @@
+// Sets that share names with different types and counts are matched in one walk over the arguments. The set chosen,
+// and every result of it, must be the one of the first set in the order they were added that parses the arguments
+// on its own, as hope_parse did when it tried the sets one after the other.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+#define NSETS 5
+#define NCASES 20000
+#define MAXARGS 8
+
+typedef struct {
+    const char *name;
+    enum hope_argtype_e type;
+    int nargs;
+} spec_t;
+
+// -n is an integer, a string and a list of doubles, -v and -x are switches in some sets, --out takes a value in all
+// but the last set, and the collectors differ in type and count
+static const char *set_names[NSETS] = {"ints", "strings", "doubles", "output", "rest"};
+static const spec_t specs[NSETS][5] = {
+    {{"-n", HOPE_TYPE_INTEGER, 1}, {"-v", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT}, {NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPTMORE}},
+    {{"-n", HOPE_TYPE_STRING, HOPE_ARGC_OPT}, {"-v", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT},
+     {"-x", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT}, {NULL, HOPE_TYPE_STRING, 2}},
+    {{"-n", HOPE_TYPE_DOUBLE, HOPE_ARGC_OPTMORE}, {"-x", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT},
+     {"--out", HOPE_TYPE_STRING, 1}},
+    {{"--out", HOPE_TYPE_STRING, HOPE_ARGC_OPT}, {"-v", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT},
+     {NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_MORE}},
+    {{"-x", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT}, {NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE}},
+};
+static const size_t nspecs[NSETS] = {3, 4, 3, 3, 2};
+
+static char *pool[] = {"-n", "-v", "-x", "--out", "1", "-3", "2.5", "abc", "--", "--ou"};
+
+static int failures = 0;
+
+// Add the sets from first to last to the parser
+static void add_sets(hope_t *hope, size_t first, size_t last){
+    hope->flags |= HOPE_FLAG_QUIET;
+    for(size_t s = first; s < last; s++){
+        hope_set_t set = hope_init_set(set_names[s]);
+        for(size_t i = 0; i < nspecs[s]; i++)
+            hope_add_param(&set, hope_init_param(specs[s][i].name, NULL, specs[s][i].type, specs[s][i].nargs));
+        hope_add_set(hope, set);
+    }
+}
+
+// Compare every result of the set in both parsers, the values of strings by content
+static bool same_results(hope_t *a, hope_t *b, size_t s){
+    for(size_t i = 0; i < nspecs[s]; i++){
+        const char *name = specs[s][i].name;
+        int na = 0, nb = 0;
+        bool switch_a, switch_b;
+        long int *ia, *ib;
+        double *da, *db;
+        const char **sa, **sb;
+        switch(specs[s][i].type){
+            case HOPE_TYPE_SWITCH:
+                na = hope_get_switch(a, name, &switch_a);
+                nb = hope_get_switch(b, name, &switch_b);
+                if(na != nb || switch_a != switch_b)
+                    return false;
+                break;
+            case HOPE_TYPE_INTEGER:
+                na = hope_get_integer(a, name, &ia);
+                nb = hope_get_integer(b, name, &ib);
+                if(na != nb || (na > 0 && memcmp(ia, ib, (size_t)na * sizeof(*ia))))
+                    return false;
+                break;
+            case HOPE_TYPE_DOUBLE:
+                na = hope_get_double(a, name, &da);
+                nb = hope_get_double(b, name, &db);
+                if(na != nb || (na > 0 && memcmp(da, db, (size_t)na * sizeof(*da))))
+                    return false;
+                break;
+            case HOPE_TYPE_STRING:
+                na = hope_get_string(a, name, &sa);
+                nb = hope_get_string(b, name, &sb);
+                if(na != nb)
+                    return false;
+                for(int k = 0; k < na; k++)
+                    if(strcmp(sa[k], sb[k]))
+                        return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// Parse with all sets at once and with every set on its own, the first set that matches alone has to be chosen
+static void check(hope_t *all, hope_t alone[NSETS], char *args[]){
+    hope_reset(all);
+    int code = hope_parse(all, args);
+    size_t first = NSETS;
+    for(size_t s = 0; s < NSETS; s++){
+        hope_reset(alone + s);
+        if(hope_parse(alone + s, args) == HOPE_SUCCESS_CODE){
+            first = s;
+            break;
+        }
+    }
+    bool ok;
+    if(first == NSETS)
+        ok = code == HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE;
+    else
+        ok = code == HOPE_SUCCESS_CODE && strcmp(all->used_set_name, set_names[first]) == 0 &&
+             same_results(all, alone + first, first);
+    if(!ok){
+        printf("first_match: {");
+        for(size_t i = 0; args[i]; i++)
+            printf(" %s", args[i]);
+        printf(" } gave %x and set %s, the first set matching alone is %s\n", code,
+               code == HOPE_SUCCESS_CODE ? all->used_set_name : "none", first < NSETS ? set_names[first] : "none");
+        failures++;
+    }
+}
+
+int main(void){
+    hope_t all = hope_init("first_match", NULL);
+    add_sets(&all, 0, NSETS);
+    hope_t alone[NSETS];
+    for(size_t s = 0; s < NSETS; s++){
+        alone[s] = hope_init("first_match", NULL);
+        add_sets(alone + s, s, s + 1);
+    }
+
+    // one list for every set, each one ruling out the sets before it
+    char *lists[][MAXARGS + 1] = {
+        {"-n", "7", "-v", "1", "2", NULL},
+        {"-n", "abc", "-x", "p", "q", NULL},
+        {"-n", "1", "2.5", "-x", "--out", "f", NULL},
+        {"--out", "f", "-v", "1.5", "2", NULL},
+        {"-x", "abc", "--", "-3", NULL},
+        {NULL},
+    };
+    for(size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
+        check(&all, alone, lists[i]);
+
+    srand(2);
+    char *args[MAXARGS + 1];
+    for(int n = 0; n < NCASES; n++){
+        int nargs = rand() % (MAXARGS + 1);
+        for(int i = 0; i < nargs; i++)
+            args[i] = pool[rand() % (sizeof(pool) / sizeof(pool[0]))];
+        args[nargs] = NULL;
+        check(&all, alone, args);
+    }
+
+    hope_free(&all);
+    for(size_t s = 0; s < NSETS; s++)
+        hope_free(alone + s);
+    printf("first_match: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,89 @@
+// Without malloc a parse works in the buffer handed to the parser. A buffer of hope_required_bytes is always enough,
+// and every buffer smaller than what a parse takes makes it fail with HOPE_ERR_CAPACITY_CODE instead of overrunning.
+// Every buffer is allocated at its exact size, so AddressSanitizer reports any byte written past it.
+#define HOPE_NO_MALLOC
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static hope_t hope;
+
+// Parse the arguments in a buffer of the given size, 1 if they parsed and the values are right, 0 for a full
+// buffer and -1 for anything else
+static int parse_in(char *args[], size_t size){
+    char *buf = malloc(size ? size : 1);
+    hope_set_buffer(&hope, buf, size);
+    int code = hope_parse(&hope, args), result = -1;
+    if(code == HOPE_SUCCESS_CODE){
+        long int *numbers;
+        const char **files;
+        result = hope_get_integer(&hope, "-n", &numbers) == 3 && numbers[2] == 30 &&
+                 hope_get_string(&hope, NULL, &files) == 4 && !strcmp(files[3], "d") && hope_get_single_switch(&hope, "-v");
+        result = result ? 1 : -1;
+    } else if(code == HOPE_ERR_CAPACITY_CODE && hope.error.code == HOPE_ERR_CAPACITY_CODE){
+        result = 0;
+    }
+    hope_reset(&hope);
+    hope_set_buffer(&hope, NULL, 0);
+    free(buf);
+    return result;
+}
+
+int main(void){
+    int failures = 0;
+    hope = hope_init("no_malloc", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    hope_set_t other = hope_init_set("other");
+    hope_add_param(&other, hope_init_param("--list", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_set(&hope, other);
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_MORE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+
+    char *args[] = {"a", "b", "-n", "10", "20", "30", "-v", "c", "d", NULL};
+    size_t argc = sizeof(args) / sizeof(args[0]) - 1;
+    size_t required = hope_required_bytes(&hope, argc);
+    if(parse_in(args, required) != 1){
+        printf("no_malloc: %zu bytes from hope_required_bytes were not enough\n", required);
+        failures++;
+    }
+    // the smallest buffer that works, every size below it has to fail cleanly
+    size_t least = 0;
+    while(least < required && parse_in(args, least) == 0)
+        least++;
+    if(parse_in(args, least) != 1){
+        printf("no_malloc: a buffer of %zu bytes neither worked nor was full\n", least);
+        failures++;
+    }
+    if(least == 0 || parse_in(args, least - 1) != 0){
+        printf("no_malloc: one byte less than %zu did not exhaust the capacity\n", least);
+        failures++;
+    }
+
+    // one set more than there is room for
+    char name[HOPE_MAX_SETS + 1][16];
+    for(int i = 2; i <= HOPE_MAX_SETS; i++){
+        snprintf(name[i], sizeof(name[i]), "set%d", i);
+        int code = hope_add_set(&hope, hope_init_set(name[i]));
+        if(code != (i < HOPE_MAX_SETS ? HOPE_SUCCESS_CODE : HOPE_ERR_CAPACITY_CODE))
+            failures++;
+    }
+    // one parameter more than there is room for
+    hope_set_t full = hope_init_set("full");
+    char param_names[HOPE_MAX_PARAMS + 1][16];
+    for(int i = 0; i <= HOPE_MAX_PARAMS; i++){
+        snprintf(param_names[i], sizeof(param_names[i]), "-p%d", i);
+        int code = hope_add_param(&full, hope_init_param(param_names[i], NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+        if(code != (i < HOPE_MAX_PARAMS ? HOPE_SUCCESS_CODE : HOPE_ERR_CAPACITY_CODE))
+            failures++;
+    }
+
+    hope_free(&hope);
+    printf("no_malloc: %zu bytes needed, %zu required, %d failures\n", least, required, failures);
+    return failures != 0;
+}
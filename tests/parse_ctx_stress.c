@@ -0,0 +1,100 @@
+// Several threads parse different argument lists against one compiled parser at once, every parse into its own
+// context. Built with -fsanitize=thread by "./build.sh tsan", which must not report any race. A second, lazy parser
+// has its values converted by the getters, which write only to the context, and its absent default read by all threads.
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+#define NTHREADS 8
+#define NROUNDS 5000
+
+static hope_t hope, lazy;
+static hope_handle_t number;
+
+// Parse with a fresh context every odd round and with one reused context every even round
+static void *parse_rounds(void *arg){
+    long id = (long)arg;
+    long failures = 0;
+    char num[32], word[32];
+    hope_parse_ctx_t reused = hope_init_parse_ctx(&hope);
+    for(long round = 0; round < NROUNDS; round++){
+        snprintf(num, sizeof(num), "%ld", id * 1000000 + round);
+        snprintf(word, sizeof(word), "t%ld", id);
+        char *main_args[] = {"-n", num, "-v", word, "x", NULL};
+        char *list_args[] = {"--list", word, word, word, NULL};
+        if(round % 2){
+            hope_parse_ctx_t ctx = hope_init_parse_ctx(&hope);
+            long int *n;
+            const char **values;
+            if(hope_parse_ctx(&ctx, main_args) != HOPE_SUCCESS_CODE || strcmp(ctx.used_set_name, "main"))
+                failures++;
+            else if(hope_ctx_get_integer_by_handle(&ctx, number, &n) != 1 || n[0] != id * 1000000 + round)
+                failures++;
+            else if(!hope_ctx_get_single_switch(&ctx, "-v"))
+                failures++;
+            else if(hope_ctx_get_string(&ctx, NULL, &values) != 2 || strcmp(values[0], word))
+                failures++;
+            hope_free_parse_ctx(&ctx);
+
+            hope_parse_ctx_t late = hope_init_parse_ctx(&lazy);
+            char *lazy_args[] = {"-n", num, NULL};
+            if(hope_parse_ctx(&late, lazy_args) != HOPE_SUCCESS_CODE)
+                failures++;
+            else if(hope_ctx_get_single_integer(&late, "-n") != id * 1000000 + round)
+                failures++;
+            else if(hope_ctx_get_single_double(&late, "-d") != 0.5)
+                failures++;
+            hope_free_parse_ctx(&late);
+        } else {
+            const char **values;
+            hope_reset_parse_ctx(&reused);
+            if(hope_parse_ctx(&reused, list_args) != HOPE_SUCCESS_CODE || strcmp(reused.used_set_name, "list"))
+                failures++;
+            else if(hope_ctx_get_string(&reused, "--list", &values) != 3 || strcmp(values[2], word))
+                failures++;
+        }
+    }
+    hope_free_parse_ctx(&reused);
+    return (void*)failures;
+}
+
+int main(void){
+    hope = hope_init("stress", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    hope_set_t main_set = hope_init_set("main");
+    hope_add_param_handle(&main_set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, 1), &number);
+    hope_add_param(&main_set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&main_set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_set(&hope, main_set);
+    hope_set_t list_set = hope_init_set("list");
+    hope_add_param(&list_set, hope_init_param("--list", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_set(&hope, list_set);
+    // the parser is only read from here on, the threads share its table
+    if(hope_compile(&hope) != HOPE_SUCCESS_CODE)
+        return 1;
+    lazy = hope_init("stress", NULL);
+    lazy.flags |= HOPE_FLAG_QUIET | HOPE_FLAG_LAZY;
+    hope_set_t lazy_set = hope_init_set("lazy");
+    hope_add_param(&lazy_set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, 1));
+    hope_add_param(&lazy_set, hope_param_default_double(hope_init_param("-d", NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_OPT), 0.5));
+    hope_add_set(&lazy, lazy_set);
+    if(hope_compile(&lazy) != HOPE_SUCCESS_CODE)
+        return 1;
+
+    pthread_t threads[NTHREADS];
+    for(long i = 0; i < NTHREADS; i++)
+        pthread_create(threads + i, NULL, parse_rounds, (void*)i);
+    long failures = 0;
+    for(int i = 0; i < NTHREADS; i++){
+        void *result;
+        pthread_join(threads[i], &result);
+        failures += (long)result;
+    }
+    hope_free(&hope);
+    hope_free(&lazy);
+    printf("parse_ctx_stress: %d threads x %d parses, %ld failed\n", NTHREADS, NROUNDS, failures);
+    return failures != 0;
+}
@@ -0,0 +1,69 @@
+// Abbreviated long names with HOPE_FLAG_PREFIX: a unique prefix resolves, an ambiguous one fails the set, a name
+// passed in full beats the longer names it is a prefix of, and without the flag nothing is abbreviated.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static int failures = 0;
+
+// Parse the arguments and check the code, the string of --output and the switches passed
+static void check(hope_t *hope, const char *what, char *args[], int code, const char *output, bool verbose, bool verb){
+    hope_reset(hope);
+    int parse_code = hope_parse(hope, args);
+    bool ok = parse_code == code;
+    if(ok && code == HOPE_SUCCESS_CODE){
+        const char *got = hope_get_single_string(hope, "--output");
+        ok = (output ? got && !strcmp(got, output) : !got) && hope_get_single_switch(hope, "--verbose") == verbose &&
+             hope_get_single_switch(hope, "--verb") == verb;
+    }
+    if(!ok){
+        printf("prefix: %s gave %x\n", what, parse_code);
+        failures++;
+    }
+}
+
+int main(void){
+    hope_t hope = hope_init("prefix", NULL);
+    hope.flags |= HOPE_FLAG_PREFIX | HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("--verbose", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("--verb", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("--version", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("--output", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+
+    char *unique[] = {"--o", "file", "--verbo", NULL};
+    check(&hope, "unique prefixes", unique, HOPE_SUCCESS_CODE, "file", true, false);
+    char *full[] = {"--output", "file", "--verbose", NULL};
+    check(&hope, "full names", full, HOPE_SUCCESS_CODE, "file", true, false);
+    // --verb is a name of its own, although it is also a prefix of --verbose
+    char *exact[] = {"--verb", NULL};
+    check(&hope, "a name that is a prefix of another", exact, HOPE_SUCCESS_CODE, NULL, false, true);
+
+    // no set matched, the error tells why the only one failed
+    char *ambiguous[] = {"--ver", NULL};
+    check(&hope, "an ambiguous prefix", ambiguous, HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE, NULL, false, false);
+    if(hope.error.code != HOPE_PARSE_ERR_AMBIGUOUS_CODE || hope.error.arg != 0 || strcmp(hope.error.value, "--ver") != 0){
+        printf("prefix: the ambiguous prefix was reported as %x at %zu\n", hope.error.code, hope.error.arg);
+        failures++;
+    }
+    // a prefix of no name and a name with more after it stay values
+    char *unknown[] = {"--x", "--outputs", NULL};
+    check(&hope, "prefixes of no name", unknown, HOPE_SUCCESS_CODE, NULL, false, false);
+    const char **values;
+    if(hope_get_string(&hope, NULL, &values) != 2)
+        failures++;
+
+    // without the flag only full names count
+    hope.flags &= ~(unsigned)HOPE_FLAG_PREFIX;
+    check(&hope, "a prefix without the flag", unique, HOPE_SUCCESS_CODE, NULL, false, false);
+    if(hope_get_string(&hope, NULL, &values) != 3 || strcmp(values[0], "--o") != 0)
+        failures++;
+
+    hope_free(&hope);
+    printf("prefix: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,75 @@
+// A parser with HOPE_FLAG_QUIET prints nothing: failed parses, getters and adding sets only store their errors.
+// stderr is pointed at a temporary file, which has to stay empty.
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+int main(void){
+    int failures = 0;
+    FILE *sink = tmpfile();
+    if(!sink)
+        return 1;
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    dup2(fileno(sink), STDERR_FILENO);
+
+    hope_t hope = hope_init("quiet", NULL);
+    hope.flags |= HOPE_FLAG_QUIET | HOPE_FLAG_LAZY;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, 1));
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_NONE));
+    hope_add_set(&hope, set);
+
+    // a second set with the same name
+    if(hope_add_set(&hope, hope_init_set("main")) != HOPE_SETADD_ERR_DUPLICATE_CODE ||
+       hope.error.code != HOPE_SETADD_ERR_DUPLICATE_CODE || strcmp(hope.error.set, "main") != 0)
+        failures++;
+
+    char *unknown[] = {"--nope", NULL};
+    if(hope_parse(&hope, unknown) == HOPE_SUCCESS_CODE || hope.error.code == HOPE_SUCCESS_CODE)
+        failures++;
+
+    hope_reset(&hope);
+    char *lazy[] = {"-n", "ten", NULL};
+    if(hope_parse(&hope, lazy) != HOPE_SUCCESS_CODE)
+        failures++;
+    long int *numbers;
+    bool flag;
+    // the lazy value is no number
+    if(hope_get_integer(&hope, "-n", &numbers) != -1 || hope.error.code != HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE)
+        failures++;
+    // no such parameter
+    if(hope_get_switch(&hope, "-x", &flag) != -1 || hope.error.code != HOPE_GET_ERR_NOEXIST_CODE ||
+       strcmp(hope.error.param, "-x") != 0)
+        failures++;
+    // a switch read as an integer
+    if(hope_get_integer(&hope, "-v", &numbers) != -1 || hope.error.code != HOPE_GET_ERR_TYPE_MISMATCH_CODE ||
+       strcmp(hope.error.value, "switch") != 0)
+        failures++;
+
+    hope_parse_ctx_t ctx = hope_init_parse_ctx(&hope);
+    if(hope_parse_ctx(&ctx, unknown) == HOPE_SUCCESS_CODE)
+        failures++;
+    hope_reset_parse_ctx(&ctx);
+    if(hope_parse_ctx(&ctx, lazy) != HOPE_SUCCESS_CODE || hope_ctx_get_switch(&ctx, "-x", &flag) != -1 ||
+       ctx.error.code != HOPE_GET_ERR_NOEXIST_CODE)
+        failures++;
+    hope_free_parse_ctx(&ctx);
+    hope_free(&hope);
+
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    fseek(sink, 0, SEEK_END);
+    long written = ftell(sink);
+    if(written != 0){
+        printf("quiet: %ld bytes were written to stderr\n", written);
+        failures++;
+    }
+    fclose(sink);
+    printf("quiet: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,157 @@
+// hope_read_fd through a pipe, read in chunks of 8 bytes so values straddle reads and outgrow the buffer. A writer
+// thread hands the input over in pieces, like a producer that is still running. NUL and newline delimiters, a last
+// value without a delimiter, empty values, conversion errors, too many values and a callback stopping the read.
+#define HOPE_READ_CHUNK 8
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+typedef struct {
+    int fd;
+    const char *data;
+    size_t size;
+} writer_t;
+
+static int failures = 0;
+
+// Write the input in pieces of 3 bytes and close the pipe
+static void *write_pieces(void *arg){
+    writer_t *writer = (writer_t*)arg;
+    for(size_t done = 0; done < writer->size; done += 3){
+        size_t piece = writer->size - done < 3 ? writer->size - done : 3;
+        if(write(writer->fd, writer->data + done, piece) != (ssize_t)piece)
+            break;
+    }
+    close(writer->fd);
+    return NULL;
+}
+
+// Parse the arguments, then read the input of size bytes through a pipe into the collector or the callback
+static int read_input(hope_t *hope, char *args[], const char *data, size_t size, char delim, hope_stream_cb_t cb, void *user){
+    int fds[2];
+    if(hope_parse(hope, args) != HOPE_SUCCESS_CODE || pipe(fds) != 0)
+        return -1;
+    writer_t writer = { fds[1], data, size };
+    pthread_t thread;
+    pthread_create(&thread, NULL, write_pieces, &writer);
+    int code = hope_read_fd(hope, fds[0], delim, cb, user);
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    return code;
+}
+
+// A parser whose only set has a collector of the type for up to nargs values
+static hope_t init_collector(enum hope_argtype_e type, int nargs){
+    hope_t hope = hope_init("read_fd", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param(NULL, NULL, type, nargs));
+    hope_add_set(&hope, set);
+    return hope;
+}
+
+// Check the strings the collector ended up with
+static void check_strings(const char *what, hope_t *hope, const char **expected, int nexpected){
+    const char **values;
+    int count = hope_get_string(hope, NULL, &values);
+    bool ok = count == nexpected;
+    for(int i = 0; ok && i < nexpected; i++)
+        ok = strcmp(values[i], expected[i]) == 0;
+    if(!ok){
+        printf("read_fd: %s gave %d values\n", what, count);
+        failures++;
+    }
+}
+
+typedef struct {
+    long sum;
+    int calls;
+    int stop_at;
+} seen_t;
+
+// Add up the integers passed, stopping with 7 at the given call
+static int add_up(const hope_value_t *value, void *user){
+    seen_t *seen = (seen_t*)user;
+    seen->sum += value->value.integer;
+    return ++seen->calls == seen->stop_at ? 7 : 0;
+}
+
+int main(void){
+    char *none[] = {NULL};
+    char *first[] = {"-v", "first", NULL};
+
+    // NUL delimited, with newlines and a value longer than the buffer, the last one has no delimiter
+    hope_t hope = init_collector(HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE);
+    static const char nuls[] = "alpha\0line\nbreak\0\0a-value-longer-than-the-chunks\0end";
+    if(read_input(&hope, first, nuls, sizeof(nuls) - 1, '\0', NULL, NULL) != HOPE_SUCCESS_CODE)
+        failures++;
+    const char *nul_values[] = {"first", "alpha", "line\nbreak", "a-value-longer-than-the-chunks", "end"};
+    check_strings("NUL delimited values", &hope, nul_values, 5);
+
+    // newline delimited, the empty lines are skipped
+    hope_reset(&hope);
+    static const char lines[] = "one\ntwo\n\n\nthree\n";
+    if(read_input(&hope, none, lines, sizeof(lines) - 1, '\n', NULL, NULL) != HOPE_SUCCESS_CODE)
+        failures++;
+    const char *line_values[] = {"one", "two", "three"};
+    check_strings("newline delimited values", &hope, line_values, 3);
+
+    // nothing at all leaves the collector as it was
+    hope_reset(&hope);
+    const char **values;
+    if(read_input(&hope, none, "", 0, '\n', NULL, NULL) != HOPE_SUCCESS_CODE || hope_get_string(&hope, NULL, &values) != 0)
+        failures++;
+    hope_free(&hope);
+
+    // integers straddling the reads, the input ends in the middle of the last one
+    hope = init_collector(HOPE_TYPE_INTEGER, HOPE_ARGC_OPTMORE);
+    static const char numbers[] = "1\n22\n333\n4444\n55555\n666666\n7777777\n88888888\n999999999";
+    if(read_input(&hope, none, numbers, sizeof(numbers) - 1, '\n', NULL, NULL) != HOPE_SUCCESS_CODE)
+        failures++;
+    long int *integers;
+    if(hope_get_integer(&hope, NULL, &integers) != 9 || integers[2] != 333 || integers[7] != 88888888 || integers[8] != 999999999){
+        printf("read_fd: integers straddling reads were not converted\n");
+        failures++;
+    }
+
+    // a value that is no integer fails the read, at its position among the values read
+    hope_reset(&hope);
+    static const char bad[] = "1\n2\nthree\n4\n";
+    if(read_input(&hope, none, bad, sizeof(bad) - 1, '\n', NULL, NULL) != HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE ||
+       hope.error.code != HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE || hope.error.arg != 2){
+        printf("read_fd: a bad integer gave %x at %zu\n", hope.error.code, hope.error.arg);
+        failures++;
+    }
+
+    // the callback sees every value as it arrives, the collector is left alone
+    hope_reset(&hope);
+    seen_t seen = {0};
+    if(read_input(&hope, none, numbers, sizeof(numbers) - 1, '\n', add_up, &seen) != HOPE_SUCCESS_CODE ||
+       seen.calls != 9 || seen.sum != 1097393685 || hope_get_integer(&hope, NULL, &integers) != 0){
+        printf("read_fd: the callback saw %d values adding up to %ld\n", seen.calls, seen.sum);
+        failures++;
+    }
+    // stopping hands the code of the callback back
+    hope_reset(&hope);
+    seen = (seen_t){ .stop_at = 3 };
+    if(read_input(&hope, none, numbers, sizeof(numbers) - 1, '\n', add_up, &seen) != 7 || seen.calls != 3 || hope.error.code != 7)
+        failures++;
+    hope_free(&hope);
+
+    // a collector of two values that got them already
+    hope = init_collector(HOPE_TYPE_STRING, 2);
+    char *two[] = {"a", "b", NULL};
+    if(read_input(&hope, two, "c\0", 2, '\0', NULL, NULL) != HOPE_PARSE_ERR_PARAM_MISCOUNT_CODE || hope.error.arg != 0){
+        printf("read_fd: too many values gave %x at %zu\n", hope.error.code, hope.error.arg);
+        failures++;
+    }
+    hope_free(&hope);
+
+    printf("read_fd: %d failures\n", failures);
+    return failures != 0;
+}
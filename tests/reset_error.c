@@ -0,0 +1,38 @@
+// Resetting a parser or a context drops the error of the parse before, so it can not be mistaken for one of the next.
+#include <stdio.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+int main(void){
+    int failures = 0;
+    hope_t hope = hope_init("reset", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, 1));
+    hope_add_set(&hope, set);
+    char *bad[] = {"-n", "many", NULL};
+    char *good[] = {"-n", "5", NULL};
+
+    if(hope_parse(&hope, bad) == HOPE_SUCCESS_CODE || hope.error.code == HOPE_SUCCESS_CODE)
+        failures++;
+    hope_reset(&hope);
+    if(hope.error.code != HOPE_SUCCESS_CODE || hope.error.param != NULL)
+        failures++;
+    if(hope_parse(&hope, good) != HOPE_SUCCESS_CODE || hope.error.code != HOPE_SUCCESS_CODE)
+        failures++;
+
+    hope_parse_ctx_t ctx = hope_init_parse_ctx(&hope);
+    if(hope_parse_ctx(&ctx, bad) == HOPE_SUCCESS_CODE || ctx.error.code == HOPE_SUCCESS_CODE)
+        failures++;
+    hope_reset_parse_ctx(&ctx);
+    if(ctx.error.code != HOPE_SUCCESS_CODE || ctx.error.param != NULL)
+        failures++;
+    if(hope_parse_ctx(&ctx, good) != HOPE_SUCCESS_CODE || ctx.error.code != HOPE_SUCCESS_CODE)
+        failures++;
+    hope_free_parse_ctx(&ctx);
+
+    hope_free(&hope);
+    printf("reset_error: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,75 @@
+// Once a parser has warmed up, resetting it and parsing again reuses its memory, the allocator is not called again.
+// HOPE_ALLOC_STATS counts every call to the allocator of the parser and of a context.
+#include <stdio.h>
+
+#define HOPE_ALLOC_STATS
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+#define NPARAMS 200
+#define NROUNDS 1000
+// the largest list is parsed first in round 1, and the reset before round 2 merges the blocks it took into one
+#define WARMUP 3
+
+static char names[NPARAMS][16];
+static char *long_args[600 + NPARAMS * 3 + 1];
+
+int main(void){
+    hope_t hope = hope_init("reset", NULL);
+    hope_set_t many = hope_init_set("many");
+    for(int i = 0; i < NPARAMS; i++){
+        snprintf(names[i], sizeof(names[i]), "-p%d", i);
+        hope_add_param(&many, hope_init_param(names[i], NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPTMORE));
+    }
+    hope_add_param(&many, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, many);
+    hope_set_t single = hope_init_set("single");
+    hope_add_param(&single, hope_init_param("-x", NULL, HOPE_TYPE_DOUBLE, 1));
+    hope_add_set(&hope, single);
+
+    size_t n = 0;
+    for(int i = 0; i < 600; i++)
+        long_args[n++] = "file";
+    for(int i = 0; i < NPARAMS; i++){
+        long_args[n++] = names[i];
+        long_args[n++] = "1";
+        long_args[n++] = "2";
+    }
+    long_args[n] = NULL;
+    char *short_args[] = {"-x", "1.5", NULL};
+
+    // the argument lists take turns, so the memory of the larger one is reused by the smaller one and back
+    int failures = 0;
+    size_t warm_calls = 0;
+    for(int round = 0; round < NROUNDS; round++){
+        if(round == WARMUP)
+            warm_calls = hope.alloc.calls;
+        hope_reset(&hope);
+        if(hope_parse(&hope, round % 3 ? long_args : short_args) != HOPE_SUCCESS_CODE)
+            failures++;
+    }
+    printf("reset_no_alloc: parser %zu calls after warm-up, %zu after %d more parses\n",
+           warm_calls, hope.alloc.calls, NROUNDS - WARMUP);
+    if(hope.alloc.calls != warm_calls)
+        failures++;
+
+    hope_parse_ctx_t ctx = hope_init_parse_ctx(&hope);
+    for(int round = 0; round < NROUNDS; round++){
+        if(round == WARMUP)
+            warm_calls = ctx.alloc.calls;
+        hope_reset_parse_ctx(&ctx);
+        if(hope_parse_ctx(&ctx, round % 3 ? long_args : short_args) != HOPE_SUCCESS_CODE)
+            failures++;
+    }
+    printf("reset_no_alloc: context %zu calls after warm-up, %zu after %d more parses\n",
+           warm_calls, ctx.alloc.calls, NROUNDS - WARMUP);
+    if(ctx.alloc.calls != warm_calls)
+        failures++;
+    hope_free_parse_ctx(&ctx);
+
+    // everything the parser allocated is given back
+    hope_free(&hope);
+    if(hope.alloc.bytes != 0)
+        failures++;
+    return failures != 0;
+}
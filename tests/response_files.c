@@ -0,0 +1,141 @@
+// Response files: quoting and escapes, NUL separators, an argument ending the last page of the file, nested files,
+// files including each other, empty files and files that can not be read.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static char dir[] = "/tmp/hope_response_XXXXXX";
+static int failures = 0;
+
+// Write the file in the test directory and return the @path argument naming it
+static char *write_file(const char *name, const char *data, size_t size){
+    static char args[16][256];
+    static int next = 0;
+    char *arg = args[next++ % 16];
+    snprintf(arg, sizeof(args[0]), "@%s/%s", dir, name);
+    FILE *file = fopen(arg + 1, "wb");
+    if(!file || fwrite(data, 1, size, file) != size)
+        failures++;
+    if(file)
+        fclose(file);
+    return arg;
+}
+
+// Parse the arguments and check the code and, if they parsed, the values of the collector
+static void check(const char *what, char *args[], const char **expected, size_t nexpected, int code){
+    hope_t hope = hope_init("response_files", NULL);
+    hope.flags |= HOPE_FLAG_RESPONSE_FILES | HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+    int parse_code = hope_parse(&hope, args);
+    const char **values;
+    int count = parse_code == HOPE_SUCCESS_CODE ? hope_get_string(&hope, NULL, &values) : 0;
+    bool ok = parse_code == code && (code != HOPE_SUCCESS_CODE || count == (int)nexpected);
+    for(size_t i = 0; ok && code == HOPE_SUCCESS_CODE && i < nexpected; i++)
+        ok = strcmp(values[i], expected[i]) == 0;
+    if(!ok){
+        printf("response_files: %s gave code %x and %d values\n", what, parse_code, count);
+        failures++;
+    }
+    hope_free(&hope);
+}
+
+// Check the error of a file that can not be expanded, it has to name the file and the argument
+static void check_error(const char *what, char *args[], size_t arg, const char *path, int code){
+    hope_t hope = hope_init("response_files", NULL);
+    hope.flags |= HOPE_FLAG_RESPONSE_FILES | HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+    if(hope_parse(&hope, args) != code || hope.error.code != code || hope.error.arg != arg ||
+       !hope.error.value || strcmp(hope.error.value, path) != 0){
+        printf("response_files: %s gave error %x at %zu\n", what, hope.error.code, hope.error.arg);
+        failures++;
+    }
+    hope_free(&hope);
+}
+
+int main(void){
+    if(!mkdtemp(dir))
+        return 1;
+
+    static const char quoted[] = "-n 5 'a b' \"c \\\" d\" e\\ f 'g\\h'\n";
+    char *quoted_args[] = {"first", write_file("quoted.rsp", quoted, sizeof(quoted) - 1), "last", NULL};
+    const char *quoted_values[] = {"first", "a b", "c \" d", "e f", "g\\h", "last"};
+    check("quotes and escapes", quoted_args, quoted_values, 6, HOPE_SUCCESS_CODE);
+
+    static const char nuls[] = "x\0y\0\0z";
+    char *nul_args[] = {write_file("nuls.rsp", nuls, sizeof(nuls) - 1), NULL};
+    const char *nul_values[] = {"x", "y", "z"};
+    check("NUL separators", nul_args, nul_values, 3, HOPE_SUCCESS_CODE);
+
+    // the last argument fills the page, so its terminator has no room in the mapping
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char *full = malloc(page), *last = malloc(page - 1);
+    memcpy(full, "a ", 2);
+    memset(full + 2, 'p', page - 2);
+    memset(last, 'p', page - 2);
+    last[page - 2] = '\0';
+    char *page_args[] = {write_file("page.rsp", full, page), NULL};
+    const char *page_values[] = {"a", last};
+    check("an argument ending the page", page_args, page_values, 2, HOPE_SUCCESS_CODE);
+    free(full);
+    free(last);
+
+    char inner[300], outer[300];
+    char *inner_arg = write_file("inner.rsp", "inner1 inner2", 13);
+    snprintf(outer, sizeof(outer), "before %s after", inner_arg);
+    char *nested_args[] = {write_file("outer.rsp", outer, strlen(outer)), "end", NULL};
+    const char *nested_values[] = {"before", "inner1", "inner2", "after", "end"};
+    check("nested files", nested_args, nested_values, 5, HOPE_SUCCESS_CODE);
+
+    char *empty_args[] = {"a", write_file("empty.rsp", "", 0), "b", NULL};
+    const char *empty_values[] = {"a", "b"};
+    check("an empty file", empty_args, empty_values, 2, HOPE_SUCCESS_CODE);
+    char *blank_args[] = {write_file("blank.rsp", " \n\t\n", 4), NULL};
+    check("a file of whitespace", blank_args, NULL, 0, HOPE_SUCCESS_CODE);
+
+    // a file including itself, and two including each other
+    snprintf(inner, sizeof(inner), "@%s/self.rsp", dir);
+    char *self_arg = write_file("self.rsp", inner, strlen(inner));
+    char *self_args[] = {"x", self_arg, NULL};
+    check_error("a file including itself", self_args, 1, self_arg + 1, HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE);
+    snprintf(inner, sizeof(inner), "@%s/ping.rsp", dir);
+    write_file("pong.rsp", inner, strlen(inner));
+    snprintf(inner, sizeof(inner), "@%s/pong.rsp", dir);
+    char *ping_arg = write_file("ping.rsp", inner, strlen(inner));
+    char *cycle_args[] = {ping_arg, NULL};
+    check_error("files including each other", cycle_args, 0, ping_arg + 1, HOPE_PARSE_ERR_RESPONSE_CYCLE_CODE);
+
+    snprintf(inner, sizeof(inner), "@%s/missing.rsp", dir);
+    char *missing_args[] = {"x", "y", inner, NULL};
+    check_error("a missing file", missing_args, 2, inner + 1, HOPE_PARSE_ERR_RESPONSE_FILE_CODE);
+    snprintf(outer, sizeof(outer), "@%s", dir);
+    char *dir_args[] = {outer, NULL};
+    check_error("a directory", dir_args, 0, dir, HOPE_PARSE_ERR_RESPONSE_FILE_CODE);
+    // the error names the file that failed, the position is the one of the argument naming the outer file
+    char *outer_missing = write_file("outer_missing.rsp", inner, strlen(inner));
+    char *nested_missing_args[] = {"x", outer_missing, NULL};
+    check_error("a missing nested file", nested_missing_args, 1, inner + 1, HOPE_PARSE_ERR_RESPONSE_FILE_CODE);
+    char *unterminated = write_file("quote.rsp", "'open", 5);
+    char *quote_args[] = {unterminated, NULL};
+    check_error("an unterminated quote", quote_args, 0, unterminated + 1, HOPE_PARSE_ERR_RESPONSE_FILE_CODE);
+
+    const char *names[] = {"quoted", "nuls", "page", "inner", "outer", "empty", "blank", "self", "ping", "pong",
+                           "outer_missing", "quote"};
+    char path[300];
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+        snprintf(path, sizeof(path), "%s/%s.rsp", dir, names[i]);
+        remove(path);
+    }
+    rmdir(dir);
+    printf("response_files: %d failures\n", failures);
+    return failures != 0;
+}
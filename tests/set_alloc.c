@@ -0,0 +1,98 @@
+// A set built without an allocator is taken over by the parser it is added to. Its memory is counted by the parser's
+// alloc and, if that has a ctx, copied to it, so every byte is freed through the ctx it was taken from.
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    long live;
+    long calls;
+} counter_t;
+
+static counter_t plain;
+
+static counter_t *counter_of(void *ctx){
+    return ctx ? (counter_t*)ctx : &plain;
+}
+
+static void *counted_malloc(void *ctx, size_t size){
+    counter_of(ctx)->live += (long)size;
+    counter_of(ctx)->calls++;
+    return malloc(size);
+}
+
+static void *counted_realloc(void *ctx, void *ptr, size_t old_size, size_t size){
+    counter_of(ctx)->live += (long)size - (long)old_size;
+    counter_of(ctx)->calls++;
+    return realloc(ptr, size);
+}
+
+static void counted_free(void *ctx, void *ptr, size_t size){
+    counter_of(ctx)->live -= (long)size;
+    free(ptr);
+}
+
+#define HOPE_MALLOC(ctx, size) counted_malloc(ctx, size)
+#define HOPE_REALLOC(ctx, ptr, old_size, size) counted_realloc(ctx, ptr, old_size, size)
+#define HOPE_FREE(ctx, ptr, size) counted_free(ctx, ptr, size)
+#define HOPE_ALLOC_STATS
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+// Build a set the usual way, without an allocator
+static hope_set_t init_main(void){
+    hope_set_t set = hope_init_set("main");
+    char *names[] = {"-a", "-b", "-c", "-d", "-e", "-f", "-g", "-h", "-i", "-j"};
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        hope_add_param(&set, hope_init_param(names[i], NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_NONE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    return set;
+}
+
+// Parse with the parser, the set has to work after it was taken over
+static int check_parse(hope_t *hope){
+    char *args[] = {"-c", "x", "y", NULL};
+    const char **values;
+    if(hope_parse(hope, args) != HOPE_SUCCESS_CODE || !hope_get_single_switch(hope, "-c") ||
+       hope_get_string(hope, NULL, &values) != 2)
+        return 1;
+    return 0;
+}
+
+int main(void){
+    int failures = 0;
+
+    // the parser has an allocator of its own, the set's memory moves there when it is added
+    counter_t own = {0};
+    hope_t hope = hope_init("set_alloc", NULL);
+    hope.alloc.ctx = &own;
+    hope_set_t set = init_main();
+    long built = plain.live;
+    if(built <= 0 || hope_add_set(&hope, set) != HOPE_SUCCESS_CODE)
+        failures++;
+    if(plain.live != 0 || hope.alloc.bytes != (size_t)own.live)
+        failures++;
+    failures += check_parse(&hope);
+    hope_free(&hope);
+    if(plain.live != 0 || own.live != 0 || hope.alloc.bytes != 0){
+        printf("set_alloc: %ld bytes left through no ctx, %ld through the parser's\n", plain.live, own.live);
+        failures++;
+    }
+
+    // with the ctx of malloc nothing is copied, the parser only counts the memory
+    hope = hope_init("set_alloc", NULL);
+    set = init_main();
+    long calls = plain.calls;
+    if(hope_add_set(&hope, set) != HOPE_SUCCESS_CODE || plain.calls != calls + 1)
+        failures++;
+    if(hope.alloc.bytes != (size_t)plain.live)
+        failures++;
+    failures += check_parse(&hope);
+    hope_free(&hope);
+    if(plain.live != 0 || hope.alloc.bytes != 0){
+        printf("set_alloc: %ld bytes left, %zu counted by the parser\n", plain.live, hope.alloc.bytes);
+        failures++;
+    }
+
+    printf("set_alloc: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,103 @@
+// --name=value with HOPE_FLAG_EQUALS and clusters of short names with HOPE_FLAG_CLUSTER. Attached values point into
+// the argument, a cluster only counts if every letter is a name, and anything that does not resolve stays a value.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static int failures = 0;
+
+// Parse the arguments and check the code and the switches -x and -v
+static void check(hope_t *hope, const char *what, char *args[], int code, bool x, bool v){
+    hope_reset(hope);
+    int parse_code = hope_parse(hope, args);
+    if(parse_code != code || (code == HOPE_SUCCESS_CODE &&
+       (hope_get_single_switch(hope, "-x") != x || hope_get_single_switch(hope, "-v") != v))){
+        printf("shorthands: %s gave %x\n", what, parse_code);
+        failures++;
+    }
+}
+
+// Check the string values the parameter got
+static void check_values(hope_t *hope, const char *what, const char *name, const char **expected, int nexpected){
+    const char **values;
+    int count = hope_get_string(hope, name, &values);
+    bool ok = count == nexpected;
+    for(int i = 0; ok && i < nexpected; i++)
+        ok = strcmp(values[i], expected[i]) == 0;
+    if(!ok){
+        printf("shorthands: %s gave %d values for %s\n", what, count, name ? name : "the collector");
+        failures++;
+    }
+}
+
+int main(void){
+    hope_t hope = hope_init("shorthands", NULL);
+    hope.flags |= HOPE_FLAG_EQUALS | HOPE_FLAG_CLUSTER | HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-x", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("-f", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("--name", NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_param(&set, hope_init_param("--level", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+
+    // the value after = points into the argument itself
+    char level[] = "--level=3";
+    char *equals[] = {level, "--name=a=b", "c", NULL};
+    check(&hope, "--name=value", equals, HOPE_SUCCESS_CODE, false, false);
+    const char *name_values[] = {"a=b", "c"};
+    check_values(&hope, "--name=value", "--name", name_values, 2);
+    if(hope_get_single_integer(&hope, "--level") != 3)
+        failures++;
+    const char **values;
+    if(hope_get_string(&hope, "--name", &values) != 2 || values[0] != equals[1] + 7)
+        failures++;
+
+    // an empty value after = is a value all the same
+    char *empty[] = {"--name=", NULL};
+    check(&hope, "--name=", empty, HOPE_SUCCESS_CODE, false, false);
+    const char *empty_values[] = {""};
+    check_values(&hope, "--name=", "--name", empty_values, 1);
+    // a value that does not convert fails the set like a separate one would
+    char *bad_level[] = {"--level=three", NULL};
+    check(&hope, "--level=three", bad_level, HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE, false, false);
+    // no such name before the =, the argument is a value
+    char *unknown_equals[] = {"--other=1", NULL};
+    check(&hope, "--other=1", unknown_equals, HOPE_SUCCESS_CODE, false, false);
+    const char *unknown_equals_values[] = {"--other=1"};
+    check_values(&hope, "--other=1", NULL, unknown_equals_values, 1);
+
+    // switches clustered, the last letter takes the rest of the argument or the next one
+    char *switches[] = {"-xv", NULL};
+    check(&hope, "-xv", switches, HOPE_SUCCESS_CODE, true, true);
+    char *last_takes[] = {"-xvf", "out", NULL};
+    check(&hope, "-xvf out", last_takes, HOPE_SUCCESS_CODE, true, true);
+    const char *out[] = {"out"};
+    check_values(&hope, "-xvf out", "-f", out, 1);
+    char *attached[] = {"-xfout", NULL};
+    check(&hope, "-xfout", attached, HOPE_SUCCESS_CODE, true, false);
+    check_values(&hope, "-xfout", "-f", out, 1);
+    char *value_only[] = {"-fout", NULL};
+    check(&hope, "-fout", value_only, HOPE_SUCCESS_CODE, false, false);
+    check_values(&hope, "-fout", "-f", out, 1);
+
+    // a letter that is no name leaves the whole cluster a value, nothing of it is switched on
+    char *unknown_letter[] = {"-xqv", NULL};
+    check(&hope, "-xqv", unknown_letter, HOPE_SUCCESS_CODE, false, false);
+    const char *unknown_letter_values[] = {"-xqv"};
+    check_values(&hope, "-xqv", NULL, unknown_letter_values, 1);
+
+    // without the flags both are plain values
+    hope.flags &= ~(unsigned)(HOPE_FLAG_EQUALS | HOPE_FLAG_CLUSTER);
+    char *plain[] = {"-xv", "--name=a", NULL};
+    check(&hope, "without the flags", plain, HOPE_SUCCESS_CODE, false, false);
+    const char *plain_values[] = {"-xv", "--name=a"};
+    check_values(&hope, "without the flags", NULL, plain_values, 2);
+
+    hope_free(&hope);
+    printf("shorthands: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,179 @@
+// A static parameter table, written with an X-macro, parses the same as the set built from the same entries with
+// hope_add_param: the same set, codes, errors and values. Its defaults are read without calling the allocator and
+// its handles come from the indices of the X-macro. HOPE_ALLOC_STATS counts the memory of the parser.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_ALLOC_STATS
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+#define OPTIONS(X) \
+    X(OPT_VERBOSE, HOPE_PARAM("-v", "Print more", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT)) \
+    X(OPT_JOBS, HOPE_PARAM_DEFAULT_INTEGER("-j", "Jobs to run", HOPE_ARGC_OPT, 4)) \
+    X(OPT_RATIO, HOPE_PARAM_DEFAULT_DOUBLE("-r", "Ratio", HOPE_ARGC_OPT, 0.25)) \
+    X(OPT_OUTPUT, HOPE_PARAM_DEFAULT_STRING("-o", "Output", HOPE_ARGC_OPT, "a.out")) \
+    X(OPT_LEVEL, HOPE_PARAM("-n", "Level", HOPE_TYPE_INTEGER, HOPE_ARGC_OPT)) \
+    X(OPT_LIBS, HOPE_PARAM_DEFAULT_STRING("--lib", "Libraries", HOPE_ARGC_OPTMORE, "c")) \
+    X(OPT_FILES, HOPE_PARAM(NULL, "Input files", HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE))
+#define AS_INDEX(id, param) id,
+#define AS_PARAM(id, param) param,
+enum { OPTIONS(AS_INDEX) };
+static const char main_set[] = "main";
+static const hope_param_t main_params[] = { OPTIONS(AS_PARAM) };
+
+static const hope_param_t list_params[] = {
+    HOPE_PARAM("--list", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE),
+    HOPE_PARAM_DEFAULT_DOUBLE("-r", NULL, HOPE_ARGC_OPT, 1.5),
+};
+
+static int failures = 0;
+
+// Build the sets of the static tables with hope_add_param, the list first so the main set does not collect --list
+static void add_dynamic(hope_t *hope){
+    hope_set_t set = hope_init_set("list");
+    hope_add_param(&set, hope_init_param("--list", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_param(&set, hope_param_default_double(hope_init_param("-r", NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_OPT), 1.5));
+    hope_add_set(hope, set);
+    set = hope_init_set(main_set);
+    hope_add_param(&set, hope_init_param("-v", "Print more", HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_param_default_integer(hope_init_param("-j", "Jobs to run", HOPE_TYPE_INTEGER, HOPE_ARGC_OPT), 4));
+    hope_add_param(&set, hope_param_default_double(hope_init_param("-r", "Ratio", HOPE_TYPE_DOUBLE, HOPE_ARGC_OPT), 0.25));
+    hope_add_param(&set, hope_param_default_string(hope_init_param("-o", "Output", HOPE_TYPE_STRING, HOPE_ARGC_OPT), "a.out"));
+    hope_add_param(&set, hope_init_param("-n", "Level", HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_param_default_string(hope_init_param("--lib", "Libraries", HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE),
+                                                   "c"));
+    hope_add_param(&set, hope_init_param(NULL, "Input files", HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(hope, set);
+}
+
+// Check that the parse left every parameter absent and the getters read their defaults without allocating
+static void check_defaults(const char *what, hope_t *hope){
+    size_t calls = hope->alloc.calls;
+    bool verbose = true;
+    long int *jobs;
+    double *ratio;
+    const char **output, **libs;
+    if(hope_get_switch(hope, "-v", &verbose) != 1 || verbose || hope_get_single_switch(hope, "-v"))
+        failures++;
+    if(hope_get_integer(hope, "-j", &jobs) != 1 || jobs[0] != 4 || hope_get_single_integer(hope, "-j") != 4)
+        failures++;
+    if(hope_get_double(hope, "-r", &ratio) != 1 || ratio[0] != 0.25 || hope_get_single_double(hope, "-r") != 0.25)
+        failures++;
+    if(hope_get_string(hope, "-o", &output) != 1 || strcmp(output[0], "a.out") ||
+       strcmp(hope_get_single_string(hope, "-o"), "a.out"))
+        failures++;
+    if(hope_get_string(hope, "--lib", &libs) != 1 || strcmp(libs[0], "c"))
+        failures++;
+    // without a default the getters give no values and zero
+    long int *level;
+    if(hope_get_integer(hope, "-n", &level) != 0 || hope_get_single_integer(hope, "-n") != 0)
+        failures++;
+    hope_handle_t jobs_handle = { main_set, OPT_JOBS };
+    if(hope_get_single_integer_by_handle(hope, jobs_handle) != 4)
+        failures++;
+    if(hope->alloc.calls != calls){
+        printf("static_table: %s, the getters called the allocator %zu times\n", what, hope->alloc.calls - calls);
+        failures++;
+    }
+}
+
+// Parse the arguments with both parsers and compare the set, the codes and every value
+static void compare(hope_t *dynamic, hope_t *fixed, char *args[]){
+    int dynamic_code = hope_parse(dynamic, args), fixed_code = hope_parse(fixed, args);
+    if(dynamic_code != fixed_code || dynamic->error.code != fixed->error.code || dynamic->error.arg != fixed->error.arg){
+        printf("static_table: \"%s\" gave code %x, %x at %zu from the dynamic set and %x, %x at %zu from the static one\n",
+               args[0], dynamic_code, dynamic->error.code, dynamic->error.arg,
+               fixed_code, fixed->error.code, fixed->error.arg);
+        failures++;
+        return;
+    }
+    if(dynamic_code != HOPE_SUCCESS_CODE)
+        return;
+    if(strcmp(dynamic->used_set_name, fixed->used_set_name)){
+        failures++;
+        return;
+    }
+    const char **a, **b;
+    long int *ia, *ib;
+    double *da, *db;
+    int na, nb;
+    if(strcmp(fixed->used_set_name, "list") == 0){
+        na = hope_get_string(dynamic, "--list", &a);
+        nb = hope_get_string(fixed, "--list", &b);
+        for(int i = 0; na == nb && i < na; i++)
+            na -= strcmp(a[i], b[i]) != 0;
+        if(na != nb || hope_get_single_double(dynamic, "-r") != hope_get_single_double(fixed, "-r"))
+            failures++;
+        return;
+    }
+    if(hope_get_single_switch(dynamic, "-v") != hope_get_single_switch(fixed, "-v"))
+        failures++;
+    na = hope_get_integer(dynamic, "-j", &ia);
+    nb = hope_get_integer(fixed, "-j", &ib);
+    if(na != nb || (na && ia[0] != ib[0]))
+        failures++;
+    na = hope_get_integer(dynamic, "-n", &ia);
+    nb = hope_get_integer(fixed, "-n", &ib);
+    if(na != nb || (na && ia[0] != ib[0]))
+        failures++;
+    na = hope_get_double(dynamic, "-r", &da);
+    nb = hope_get_double(fixed, "-r", &db);
+    if(na != nb || (na && da[0] != db[0]))
+        failures++;
+    const char *names[] = {"-o", "--lib", NULL};
+    for(size_t n = 0; n < sizeof(names) / sizeof(names[0]); n++){
+        na = hope_get_string(dynamic, names[n], &a);
+        nb = hope_get_string(fixed, names[n], &b);
+        for(int i = 0; na == nb && i < na; i++)
+            na -= strcmp(a[i], b[i]) != 0;
+        if(na != nb){
+            printf("static_table: \"%s\" gave other values for %s\n", args[0], names[n] ? names[n] : "the collector");
+            failures++;
+        }
+    }
+}
+
+int main(void){
+    hope_t dynamic = hope_init("static_table", NULL);
+    dynamic.flags |= HOPE_FLAG_QUIET;
+    add_dynamic(&dynamic);
+    hope_t fixed = hope_init("static_table", NULL);
+    fixed.flags |= HOPE_FLAG_QUIET;
+    hope_add_set(&fixed, HOPE_INIT_STATIC_SET("list", list_params));
+    hope_add_set(&fixed, HOPE_INIT_STATIC_SET(main_set, main_params));
+    // building the static parser takes no memory for its parameters
+    if(fixed.alloc.bytes >= dynamic.alloc.bytes){
+        printf("static_table: the static parser took %zu bytes, the dynamic one %zu\n", fixed.alloc.bytes,
+               dynamic.alloc.bytes);
+        failures++;
+    }
+
+    char *empty_args[] = {NULL};
+    char *files_args[] = {"a.c", "b.c", NULL};
+    if(hope_parse(&dynamic, empty_args) != HOPE_SUCCESS_CODE || hope_parse(&fixed, files_args) != HOPE_SUCCESS_CODE)
+        failures++;
+    check_defaults("the dynamic set", &dynamic);
+    check_defaults("the static set", &fixed);
+
+    char *cases[][8] = {
+        {"-v", "-j", "8", "x", NULL},
+        {"-r", "2.5", "-o", "out", "--lib", "m", "pthread", NULL},
+        {"--lib", "-n", "3", NULL},
+        {"-j", "many", NULL},
+        {"-n", "1", "-n", "2", NULL},
+        {"--list", "a", "b", "-r", "3", NULL},
+        {"--list", "a", NULL},
+        {"--list", "a", "-j", "2", NULL},
+        {"--list", NULL},
+        {"-v", "-v", NULL},
+        {"--li", "x", NULL},
+    };
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        compare(&dynamic, &fixed, cases[i]);
+
+    hope_free(&dynamic);
+    hope_free(&fixed);
+    printf("static_table: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,86 @@
+// hope_parse_stream hands every value to the callback in the order of the arguments, converted and with the index of
+// its parameter. A callback stopping the parse hands its code back, and counts and required parameters are only
+// checked once the values before them were streamed.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+typedef struct {
+    char log[512];
+    int calls;
+    int stop_at;
+} seen_t;
+
+// Append the value to the log as name:index:value, stopping with 9 at the given call
+static int record(const hope_value_t *value, void *user){
+    seen_t *seen = (seen_t*)user;
+    char entry[64];
+    const char *name = value->name ? value->name : "*";
+    int index = value->index == HOPE_HANDLE_COLLECTOR ? -1 : (int)value->index;
+    switch(value->type){
+        case HOPE_TYPE_SWITCH: snprintf(entry, sizeof(entry), "%s:%d ", name, index); break;
+        case HOPE_TYPE_INTEGER: snprintf(entry, sizeof(entry), "%s:%d:%ld ", name, index, value->value.integer); break;
+        case HOPE_TYPE_DOUBLE: snprintf(entry, sizeof(entry), "%s:%d:%g ", name, index, value->value._double); break;
+        default: snprintf(entry, sizeof(entry), "%s:%d:%s ", name, index, value->value.string); break;
+    }
+    strncat(seen->log, entry, sizeof(seen->log) - strlen(seen->log) - 1);
+    return ++seen->calls == seen->stop_at ? 9 : 0;
+}
+
+int main(void){
+    int failures = 0;
+    hope_t hope = hope_init("stream", NULL);
+    hope.flags |= HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("main");
+    hope_add_param(&set, hope_init_param("-v", NULL, HOPE_TYPE_SWITCH, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, 2));
+    hope_add_param(&set, hope_init_param("-r", NULL, HOPE_TYPE_DOUBLE, HOPE_ARGC_MORE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_STRING, HOPE_ARGC_OPTMORE));
+    hope_add_set(&hope, set);
+
+    char *args[] = {"a", "-n", "1", "2", "-v", "-r", "0.5", "1e3", "--", "b", NULL};
+    seen_t seen = {0};
+    if(hope_parse_stream(&hope, "main", args, record, &seen) != HOPE_SUCCESS_CODE ||
+       strcmp(seen.log, "*:-1:a -n:1:1 -n:1:2 -v:0 -r:2:0.5 -r:2:1000 *:-1:b ") != 0){
+        printf("stream: the values were streamed as %s\n", seen.log);
+        failures++;
+    }
+
+    // the callback stops the parse at the third value, its code comes back without being an error
+    seen = (seen_t){ .stop_at = 3 };
+    if(hope_parse_stream(&hope, "main", args, record, &seen) != 9 || seen.calls != 3 || hope.error.code != 9)
+        failures++;
+
+    // -r is required, it is missed only after the values before the end were streamed
+    char *no_r[] = {"-n", "1", "2", "x", NULL};
+    seen = (seen_t){0};
+    if(hope_parse_stream(&hope, "main", no_r, record, &seen) != HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE ||
+       hope.error.code != HOPE_PARSE_ERR_PARAM_ARG_MISCOUNT_CODE || strcmp(hope.error.param, "-r") != 0 ||
+       strcmp(seen.log, "-n:1:1 -n:1:2 *:-1:x ") != 0){
+        printf("stream: a missing -r gave %x after %s\n", hope.error.code, seen.log);
+        failures++;
+    }
+    // -n takes at most two values, the third goes to the collector
+    char *long_n[] = {"-r", "1", "-n", "1", "2", "3", NULL};
+    seen = (seen_t){0};
+    if(hope_parse_stream(&hope, "main", long_n, record, &seen) != HOPE_SUCCESS_CODE ||
+       strcmp(seen.log, "-r:2:1 -n:1:1 -n:1:2 *:-1:3 ") != 0){
+        printf("stream: -n with three values gave %s\n", seen.log);
+        failures++;
+    }
+    // a value that does not convert fails at its argument
+    char *bad[] = {"-r", "1", "half", NULL};
+    seen = (seen_t){0};
+    if(hope_parse_stream(&hope, "main", bad, record, &seen) != HOPE_PARSE_ERR_PARAM_UNPARSABLE_CODE || hope.error.arg != 2){
+        printf("stream: a bad double gave %x at %zu\n", hope.error.code, hope.error.arg);
+        failures++;
+    }
+    if(hope_parse_stream(&hope, "other", args, record, &seen) != HOPE_PARSE_ERR_NO_SET_CODE)
+        failures++;
+
+    hope_free(&hope);
+    printf("stream: %d failures\n", failures);
+    return failures != 0;
+}
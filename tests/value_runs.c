@@ -0,0 +1,98 @@
+// Arguments that can only be values are classified in runs, which the walks pass to a set at once. A run has to be
+// split like single arguments are: the open parameter takes values up to its limit, the collector the rest, and a
+// value with nowhere to go or failing to convert is reported at its own position. Every list is parsed eagerly and
+// lazily, alone and next to a set that fails on it.
+#include <stdio.h>
+#include <string.h>
+
+#define HOPE_IMPLEMENTATION
+#include "../hope.h"
+
+static int failures = 0;
+
+// -o takes one value, -n an optional one, -l any amount and the collector two, the "strict" set has no collector
+static hope_t init_parser(unsigned flags, bool with_strict){
+    hope_t hope = hope_init("value_runs", NULL);
+    hope.flags |= HOPE_FLAG_QUIET | flags;
+    if(with_strict){
+        hope_set_t strict = hope_init_set("strict");
+        hope_add_param(&strict, hope_init_param("-o", NULL, HOPE_TYPE_STRING, 1));
+        hope_add_set(&hope, strict);
+    }
+    hope_set_t set = hope_init_set("runs");
+    hope_add_param(&set, hope_init_param("-o", NULL, HOPE_TYPE_STRING, 1));
+    hope_add_param(&set, hope_init_param("-n", NULL, HOPE_TYPE_INTEGER, HOPE_ARGC_OPT));
+    hope_add_param(&set, hope_init_param("-l", NULL, HOPE_TYPE_STRING, HOPE_ARGC_MORE));
+    hope_add_param(&set, hope_init_param(NULL, NULL, HOPE_TYPE_INTEGER, 2));
+    hope_add_set(&hope, set);
+    return hope;
+}
+
+// Compare the strings of a parameter, expected ends with NULL
+static bool same_strings(hope_t *hope, const char *name, const char *expected[]){
+    const char **values;
+    int count = hope_get_string(hope, name, &values);
+    for(int i = 0; i < count; i++)
+        if(!expected[i] || strcmp(values[i], expected[i]))
+            return false;
+    return expected[count] == NULL;
+}
+
+static void check_parsed(const char *what, hope_t *hope, char *args[]){
+    const char *output[] = {"a", NULL};
+    const char *list[] = {"x", "y", NULL};
+    long int *rest;
+    if(hope_parse(hope, args) != HOPE_SUCCESS_CODE || !same_strings(hope, "-o", output) ||
+       !same_strings(hope, "-l", list) || hope_get_single_integer(hope, "-n") != 5 ||
+       hope_get_integer(hope, NULL, &rest) != 2 || rest[0] != 1 || rest[1] != 2){
+        printf("value_runs: %s, the run was not split at the limits of the parameters\n", what);
+        failures++;
+    }
+}
+
+static void check_error(const char *what, hope_t *hope, char *args[], size_t arg){
+    if(hope_parse(hope, args) == HOPE_SUCCESS_CODE || hope->error.arg != arg){
+        printf("value_runs: %s, expected an error at argument %zu and got one at %zu\n", what, arg, hope->error.arg);
+        failures++;
+    }
+}
+
+int main(void){
+    // -o takes a and the collector 1 2, -n takes 5 and -l x y until --, the collector is full and ignores 9
+    char *split[] = {"-o", "a", "1", "2", "-n", "5", "-l", "x", "y", "--", "9", NULL};
+    // the second value of the collector is no integer, the first one is
+    char *unconverted[] = {"-l", "x", "y", "--", "1", "z", NULL};
+    // -n takes 5 and the collector converts w at the fill
+    char *after_opt[] = {"-n", "5", "w", "3", NULL};
+    static const struct {
+        const char *name;
+        unsigned flags;
+        bool with_strict;
+    } parsers[] = {
+        {"a set alone", 0, false},
+        {"a lazy set alone", HOPE_FLAG_LAZY, false},
+        {"a set after one without a collector", 0, true},
+    };
+    for(size_t p = 0; p < sizeof(parsers) / sizeof(parsers[0]); p++){
+        hope_t hope = init_parser(parsers[p].flags, parsers[p].with_strict);
+        check_parsed(parsers[p].name, &hope, split);
+        if(!(parsers[p].flags & HOPE_FLAG_LAZY)){
+            check_error(parsers[p].name, &hope, unconverted, 5);
+            check_error(parsers[p].name, &hope, after_opt, 2);
+        }
+        hope_free(&hope);
+    }
+
+    // without a collector the first value nothing takes is the error
+    hope_t strict = hope_init("value_runs", NULL);
+    strict.flags |= HOPE_FLAG_QUIET;
+    hope_set_t set = hope_init_set("strict");
+    hope_add_param(&set, hope_init_param("-o", NULL, HOPE_TYPE_STRING, 1));
+    hope_add_set(&strict, set);
+    char *extra[] = {"-o", "a", "b", "c", NULL};
+    check_error("a set without a collector", &strict, extra, 2);
+    hope_free(&strict);
+
+    printf("value_runs: %d failures\n", failures);
+    return failures != 0;
+}